@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "amo.h"
+
+using namespace std;
+
+static int node(int lit){
+  return 2*abs(lit) + (lit < 0);
+}
+
+class amo_graph {
+public:
+  amo_graph(vector<vector<int> > &clause_db, int max_var_idx);
+  bool is_clique(const vector<int> &);
+  bool has_uncovered(const vector<int> &);
+  void cover(const vector<int> &);
+  bool covered(int x, int y){ return _covered[node(x)][_find(x, y)]; }
+  bool adjacent(int x, int y){ return _find(x, y) >= 0; }
+  vector<int> &neighbors(int x){ return _adj[node(x)]; }
+private:
+  int _find(int, int);
+  vector<vector<int> > _adj;       // lits that cannot be true together, by node
+  vector<vector<char> > _covered;  // parallel to _adj, edge in some group
+};
+
+amo_graph::amo_graph(vector<vector<int> > &clause_db, int max_var_idx){
+  _adj.resize(2*max_var_idx + 2);
+  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit){
+    if(cit->size() != 2 || abs(cit->at(0)) == abs(cit->at(1)))
+      continue;
+    int x = -cit->at(0), y = -cit->at(1);
+    _adj[node(x)].push_back(y);
+    _adj[node(y)].push_back(x);
+  }
+  _covered.resize(_adj.size());
+  for(unsigned n=0; n<_adj.size(); ++n){
+    sort(_adj[n].begin(), _adj[n].end());
+    _adj[n].erase(unique(_adj[n].begin(), _adj[n].end()), _adj[n].end());
+    _covered[n].assign(_adj[n].size(), 0);
+  }
+}
+
+int amo_graph::_find(int x, int y){
+  vector<int> &adj = _adj[node(x)];
+  vector<int>::iterator it = lower_bound(adj.begin(), adj.end(), y);
+  return it != adj.end() && *it == y ? it - adj.begin() : -1;
+}
+
+bool amo_graph::is_clique(const vector<int> &lits){
+  for(unsigned i=0; i<lits.size(); ++i)
+    for(unsigned j=i+1; j<lits.size(); ++j)
+      if(!adjacent(lits[i], lits[j]))
+        return false;
+  return true;
+}
+
+bool amo_graph::has_uncovered(const vector<int> &lits){
+  for(unsigned i=0; i<lits.size(); ++i)
+    for(unsigned j=i+1; j<lits.size(); ++j)
+      if(!covered(lits[i], lits[j]))
+        return true;
+  return false;
+}
+
+void amo_graph::cover(const vector<int> &lits){
+  for(unsigned i=0; i<lits.size(); ++i)
+    for(unsigned j=i+1; j<lits.size(); ++j){
+      _covered[node(lits[i])][_find(lits[i], lits[j])] = 1;
+      _covered[node(lits[j])][_find(lits[j], lits[i])] = 1;
+    }
+}
+
+static bool more_neighbors(const pair<int, int> &a, const pair<int, int> &b){
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+int find_amo_groups(vector<vector<int> > &clause_db, int max_var_idx, vector<vector<int> > &groups, int &n_exactly_one){
+  amo_graph graph(clause_db, max_var_idx);
+
+  /* clauses over pairwise exclusive lits: exactly one of them */
+  n_exactly_one = 0;
+  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit){
+    if(cit->size() < AMO_MIN_SIZE || !graph.is_clique(*cit) || !graph.has_uncovered(*cit))
+      continue;
+    graph.cover(*cit);
+    groups.push_back(*cit);
+    ++n_exactly_one;
+  }
+
+  /* greedy cliques around each lit, most neighbors first, seeded by an edge
+   * not covered yet so that every group removes some clause */
+  vector<pair<int, int> > order;
+  for(int v=1; v<=max_var_idx; ++v)
+    for(int lit=v; lit>=-v; lit-=2*v)
+      if(graph.neighbors(lit).size() >= AMO_MIN_SIZE - 1)
+        order.push_back(make_pair(int(graph.neighbors(lit).size()), lit));
+  sort(order.begin(), order.end(), more_neighbors);
+  for(vector<pair<int, int> >::iterator oit=order.begin(); oit!=order.end(); ++oit){
+    int x = oit->second;
+    vector<int> candidate;
+    for(vector<int>::iterator y=graph.neighbors(x).begin(); y!=graph.neighbors(x).end(); ++y)
+      if(!graph.covered(x, *y))
+        candidate.push_back(*y);
+    for(unsigned seed=0; seed<candidate.size(); ++seed){
+      if(graph.covered(x, candidate[seed]))
+        continue;
+      vector<int> clique(1, x);
+      clique.push_back(candidate[seed]);
+      for(unsigned i=seed+1; i<candidate.size(); ++i){
+        bool fits = true;
+        for(unsigned j=1; j<clique.size() && fits; ++j)
+          fits = graph.adjacent(clique[j], candidate[i]);
+        if(fits)
+          clique.push_back(candidate[i]);
+      }
+      if(clique.size() < AMO_MIN_SIZE)
+        continue;
+      graph.cover(clique);
+      groups.push_back(clique);
+    }
+  }
+
+  /* drop the binary clauses some group stands for */
+  int n_kept = 0;
+  for(unsigned c=0; c<clause_db.size(); ++c){
+    vector<int> &clause = clause_db[c];
+    if(clause.size() == 2 && abs(clause[0]) != abs(clause[1]) && graph.covered(-clause[0], -clause[1]))
+      continue;
+    clause_db[n_kept++].swap(clause);
+  }
+  int n_removed = clause_db.size() - n_kept;
+  clause_db.resize(n_kept);
+  return n_removed;
+}
+
+void expand_amo_groups(const vector<vector<int> > &groups, vector<vector<int> > &clause_db){
+  for(vector<vector<int> >::const_iterator git=groups.begin(); git!=groups.end(); ++git)
+    for(unsigned i=0; i<git->size(); ++i)
+      for(unsigned j=i+1; j<git->size(); ++j){
+        vector<int> clause(2, -git->at(i));
+        clause[1] = -git->at(j);
+        clause_db.push_back(clause);
+      }
+}
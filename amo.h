@@ -0,0 +1,18 @@
+#ifndef _AMO_H_
+#define _AMO_H_
+
+#include <vector>
+using std::vector;
+
+#define AMO_MIN_SIZE 3 // smaller groups stay binary clauses
+
+/* at-most-one groups from cliques of binary clauses: (-a v -b) for every
+ * pair of a group. clauses whose lits pairwise exclude each other give
+ * exactly-one groups first, then greedy cliques over the edges left.
+ * the binary clauses covered are removed from clause_db, returns how many */
+int find_amo_groups(vector<vector<int> > &, int, vector<vector<int> > &, int &);
+
+/* the pairwise clauses of the groups, for solvers without native groups */
+void expand_amo_groups(const vector<vector<int> > &, vector<vector<int> > &);
+
+#endif
@@ -0,0 +1,206 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "branch.h"
+
+using namespace std;
+
+#define UNASSIGNED 0
+
+decider *new_decider(int kind, const vector<int> &value){
+  if(kind == BRANCH_VMTF)
+    return new vmtf_decider(value);
+  if(kind == BRANCH_LRB)
+    return new lrb_decider(value);
+  return new vsids_decider(value);
+}
+
+void vsids_decider::reset(const vector<int> &score){
+  _score = score;
+  _heap.clear();
+  for(unsigned v=1; v<_score.size(); ++v)
+    _heap.push_back(var_score(v, &_score[v]));
+  make_heap(_heap.begin(), _heap.end(), _score_cmp);
+}
+
+void vsids_decider::unassigned(int var){
+  _heap.push_back(var_score(var, &_score[var]));
+}
+
+void vsids_decider::conflict(const vector<int> &vars){
+  for(unsigned v=1; v<_score.size(); ++v)
+    --_score[v];
+}
+
+void vsids_decider::learnt(const vector<int> &clause){
+  for(vector<int>::const_iterator lit=clause.begin(); lit!=clause.end(); ++lit)
+    ++_score.at(abs(*lit));
+}
+
+int vsids_decider::next(){
+  while(!_heap.empty()){
+    int var = _heap.front().var;
+    pop_heap(_heap.begin(), _heap.end(), _score_cmp); _heap.pop_back();
+    if(_value.at(var) == UNASSIGNED)
+      return var;
+  }
+  return 0;
+}
+
+void vmtf_decider::reset(const vector<int> &score){
+  /* the first time the queue is ordered by weight, heaviest last */
+  if(_stamp.size() != score.size()){
+    vector<pair<int, int> > by_score;
+    for(unsigned v=1; v<score.size(); ++v)
+      by_score.push_back(make_pair(score[v], v));
+    stable_sort(by_score.begin(), by_score.end());
+    _prev.assign(score.size(), 0);
+    _next.assign(score.size(), 0);
+    _stamp.assign(score.size(), 0);
+    _first = _last = 0;
+    _n_bump = 0;
+    for(unsigned i=0; i<by_score.size(); ++i)
+      _enqueue(by_score[i].second);
+  }
+  _search = _last;
+}
+
+void vmtf_decider::_enqueue(int var){
+  _prev[var] = _last;
+  _next[var] = 0;
+  if(_last != 0)
+    _next[_last] = var;
+  else
+    _first = var;
+  _last = var;
+  _stamp[var] = ++_n_bump;
+}
+
+void vmtf_decider::_dequeue(int var){
+  if(_prev[var] != 0)
+    _next[_prev[var]] = _next[var];
+  else
+    _first = _next[var];
+  if(_next[var] != 0)
+    _prev[_next[var]] = _prev[var];
+  else
+    _last = _prev[var];
+}
+
+void vmtf_decider::unassigned(int var){
+  if(_stamp[var] > _stamp[_search])
+    _search = var;
+}
+
+void vmtf_decider::conflict(const vector<int> &vars){
+  vector<pair<long, int> > by_stamp;
+  for(vector<int>::const_iterator vit=vars.begin(); vit!=vars.end(); ++vit)
+    by_stamp.push_back(make_pair(_stamp[*vit], *vit));
+  sort(by_stamp.begin(), by_stamp.end());
+  for(unsigned i=0; i<by_stamp.size(); ++i){
+    int var = by_stamp[i].second;
+    if(var == _last)
+      _stamp[var] = ++_n_bump;
+    else{
+      _dequeue(var);
+      _enqueue(var);
+    }
+    if(_value[var] == UNASSIGNED)
+      _search = var;
+  }
+}
+
+int vmtf_decider::next(){
+  while(_search != 0 && _value[_search] != UNASSIGNED)
+    _search = _prev[_search];
+  return _search;
+}
+
+void lrb_decider::reset(const vector<int> &score){
+  if(_q.size() != score.size()){
+    int max_score = 1;
+    for(unsigned v=1; v<score.size(); ++v)
+      max_score = max(max_score, score[v]);
+    _q.assign(score.size(), 0);
+    for(unsigned v=1; v<score.size(); ++v)
+      _q[v] = LRB_SEED_SCALE * score[v] / max_score;
+    _assigned_at.assign(score.size(), 0);
+    _participated.assign(score.size(), 0);
+  }
+  _heap.clear();
+  _pos.assign(_q.size(), -1);
+  for(unsigned v=1; v<_q.size(); ++v){
+    _pos[v] = _heap.size();
+    _heap.push_back(v);
+  }
+  for(int i=_heap.size()/2 - 1; i>=0; --i)
+    _down(i);
+}
+
+void lrb_decider::assigned(int var){
+  _assigned_at[var] = _n_conflict;
+  _participated[var] = 0;
+}
+
+void lrb_decider::unassigned(int var){
+  long interval = _n_conflict - _assigned_at[var];
+  if(interval > 0)
+    _q[var] = (1 - _alpha) * _q[var] + _alpha * _participated[var] / interval;
+  if(_pos[var] < 0){
+    _pos[var] = _heap.size();
+    _heap.push_back(var);
+  }
+  _up(_pos[var]);
+  _down(_pos[var]);
+}
+
+void lrb_decider::conflict(const vector<int> &vars){
+  for(vector<int>::const_iterator vit=vars.begin(); vit!=vars.end(); ++vit)
+    ++_participated[*vit];
+  ++_n_conflict;
+  if(_alpha > LRB_ALPHA_MIN)
+    _alpha -= LRB_ALPHA_STEP;
+}
+
+int lrb_decider::next(){
+  while(!_heap.empty()){
+    int var = _heap.front();
+    if(_value[var] == UNASSIGNED)
+      return var;
+    _swap(0, _heap.size() - 1);
+    _pos[var] = -1;
+    _heap.pop_back();
+    if(!_heap.empty())
+      _down(0);
+  }
+  return 0;
+}
+
+void lrb_decider::_swap(int i, int j){
+  swap(_heap[i], _heap[j]);
+  _pos[_heap[i]] = i;
+  _pos[_heap[j]] = j;
+}
+
+void lrb_decider::_up(int i){
+  while(i > 0 && _q[_heap[(i-1)/2]] < _q[_heap[i]]){
+    _swap(i, (i-1)/2);
+    i = (i-1)/2;
+  }
+}
+
+void lrb_decider::_down(int i){
+  int n = _heap.size();
+  while(true){
+    int best = i;
+    if(2*i+1 < n && _q[_heap[2*i+1]] > _q[_heap[best]])
+      best = 2*i+1;
+    if(2*i+2 < n && _q[_heap[2*i+2]] > _q[_heap[best]])
+      best = 2*i+2;
+    if(best == i)
+      return;
+    _swap(i, best);
+    i = best;
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef _BRANCH_H_
+#define _BRANCH_H_
+
+#include <vector>
+using std::vector;
+
+#define BRANCH_VSIDS 0
+#define BRANCH_VMTF 1
+#define BRANCH_LRB 2
+#define BRANCH_SWITCH 3 // vmtf while restarts come fast, lrb once they are far apart
+#define BRANCH_MIX 4    // main only: the thread index picks one of the above
+
+#define STABLE_RESTART_INTERVAL 400 // conflicts between restarts that count as stable
+#define LRB_ALPHA_START 0.4
+#define LRB_ALPHA_MIN 0.06
+#define LRB_ALPHA_STEP 1e-6
+#define LRB_SEED_SCALE 1e-3 // initial scores from the occurrences, below any reward
+
+/* the var to branch on next. the solver reports every assignment and
+ * unassignment, the vars each conflict analysis went through (the learnt
+ * clause and the reason sides resolved away) and the learnt clauses it
+ * keeps. reset puts every var back as unassigned, with the occurrence
+ * weights of the clause db for the engines that use them */
+class decider {
+public:
+  decider(const vector<int> &value):_value(value){;}
+  virtual ~decider(){;}
+  virtual void reset(const vector<int> &) = 0;
+  virtual void assigned(int){;}
+  virtual void unassigned(int) = 0;
+  virtual void conflict(const vector<int> &) = 0;
+  virtual void learnt(const vector<int> &){;}
+  virtual int next() = 0; // an unassigned var, 0 if there is none
+  virtual double activity(int) = 0;
+protected:
+  const vector<int> &_value; // by var, the solver's assignment
+};
+
+/* one of BRANCH_VSIDS, BRANCH_VMTF or BRANCH_LRB over the solver's values */
+decider *new_decider(int, const vector<int> &);
+
+struct var_score {
+  int var;
+  int *score;
+  var_score(int v, int *s):var(v),score(s){;}
+};
+
+/* integer scores: weights at reset, +1 per learnt clause holding the var,
+ * -1 for all on every conflict. vars go back to the heap unsorted */
+class vsids_decider : public decider {
+public:
+  vsids_decider(const vector<int> &value):decider(value){;}
+  void reset(const vector<int> &);
+  void unassigned(int);
+  void conflict(const vector<int> &);
+  void learnt(const vector<int> &);
+  int next();
+  double activity(int var){ return _score.at(var); }
+private:
+  static bool _score_cmp(const var_score &vs1, const var_score &vs2){
+    return *vs1.score > *vs2.score;
+  }
+  vector<int> _score;
+  vector<var_score> _heap;
+};
+
+/* variable move-to-front: a doubly linked queue by bump time, the vars of
+ * each conflict moved to its end in their old order. _search is the newest
+ * var that may be unassigned, everything after it is assigned. the queue
+ * survives reset */
+class vmtf_decider : public decider {
+public:
+  vmtf_decider(const vector<int> &value):decider(value),_first(0),_last(0),_search(0),_n_bump(0){;}
+  void reset(const vector<int> &);
+  void unassigned(int);
+  void conflict(const vector<int> &);
+  int next();
+  double activity(int var){ return _stamp.at(var); }
+private:
+  void _enqueue(int);
+  void _dequeue(int);
+  vector<int> _prev;
+  vector<int> _next;
+  vector<long> _stamp; // bump time, [0] stays 0
+  int _first;
+  int _last;
+  int _search;
+  long _n_bump;
+};
+
+/* learning rate branching: while a var is assigned, the share of the
+ * conflicts whose analysis held it is its reward, folded into the score by
+ * an exponential moving average when it gets unassigned. the step size
+ * alpha shrinks per conflict. scores survive reset */
+class lrb_decider : public decider {
+public:
+  lrb_decider(const vector<int> &value):decider(value),_alpha(LRB_ALPHA_START),_n_conflict(0){;}
+  void reset(const vector<int> &);
+  void assigned(int);
+  void unassigned(int);
+  void conflict(const vector<int> &);
+  int next();
+  double activity(int var){ return _q.at(var); }
+private:
+  void _up(int);
+  void _down(int);
+  void _swap(int, int);
+  vector<double> _q;
+  vector<long> _assigned_at;   // conflict count at the assignment
+  vector<int> _participated;   // conflicts analyzed since the assignment
+  vector<int> _heap;           // binary max heap on _q
+  vector<int> _pos;            // of each var in _heap, -1 outside
+  double _alpha;
+  long _n_conflict;
+};
+
+#endif
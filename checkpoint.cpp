@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include <utility>
+#include "checkpoint.h"
+
+using namespace std;
+
+/* the file: magic, the formula hash in 8 bytes least significant first,
+ * then 7-bit varints as in binary DRAT: n_var, a phase byte per var
+ * (0 free, 1 true, 2 false), 1 and a rank per var or 0, n_clause, then
+ * lbd, size and the 2*var+sign literals of every clause */
+
+static void put_uint(vector<unsigned char> &buf, unsigned int u){
+  while(u > 127){
+    buf.push_back(128 | (u & 127));
+    u >>= 7;
+  }
+  buf.push_back(u);
+}
+
+static bool get_uint(const vector<unsigned char> &buf, unsigned &pos, unsigned int &fill_u){
+  fill_u = 0;
+  for(int shift=0; shift<32; shift+=7){
+    if(pos >= buf.size())
+      return false;
+    unsigned char byte = buf[pos++];
+    fill_u |= (byte & 127u) << shift;
+    if(byte < 128)
+      return true;
+  }
+  return false;
+}
+
+void checkpoint::keep_learnt(const vector<vector<int> > &clause_db, const vector<int> &clause_lbd, int ori_db_size){
+  clause.clear();
+  lbd.clear();
+  for(unsigned c=ori_db_size; c<clause_db.size(); ++c){
+    if(clause_db[c].size() > 2 && clause_lbd[c] > CHECKPOINT_KEEP_LBD)
+      continue;
+    clause.push_back(clause_db[c]);
+    lbd.push_back(clause_lbd[c]);
+  }
+}
+
+void checkpoint::rank_activity(const vector<double> &activity){
+  vector<pair<double, int> > by_activity;
+  for(unsigned v=1; v<activity.size(); ++v)
+    by_activity.push_back(make_pair(activity[v], v));
+  stable_sort(by_activity.begin(), by_activity.end());
+  rank.assign(activity.size(), 0);
+  for(unsigned i=0; i<by_activity.size(); ++i)
+    rank[by_activity[i].second] = i;
+}
+
+uint64_t formula_hash(const vector<vector<int> > &clause_db, int n_clause){
+  /* fnv-1a over the literals, a 0 closing every clause */
+  uint64_t h = UINT64_C(0xcbf29ce484222325);
+  for(int c=0; c<n_clause; ++c){
+    for(vector<int>::const_iterator lit=clause_db[c].begin(); lit!=clause_db[c].end(); ++lit)
+      h = (h ^ uint32_t(*lit)) * UINT64_C(0x100000001b3);
+    h *= UINT64_C(0x100000001b3);
+  }
+  return h;
+}
+
+bool write_checkpoint(const char *filename, uint64_t hash, int n_var, const checkpoint &state){
+  vector<unsigned char> buf(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + 8);
+  for(int i=0; i<8; ++i)
+    buf.push_back((hash >> (8*i)) & 255);
+  put_uint(buf, n_var);
+  for(int v=1; v<=n_var; ++v){
+    int lit = v < int(state.phase.size()) ? state.phase[v] : 0;
+    buf.push_back(lit == 0 ? 0 : (lit > 0 ? 1 : 2));
+  }
+  bool has_rank = int(state.rank.size()) == n_var + 1;
+  put_uint(buf, has_rank);
+  for(int v=1; v<=n_var && has_rank; ++v)
+    put_uint(buf, state.rank[v]);
+  put_uint(buf, state.clause.size());
+  for(unsigned c=0; c<state.clause.size(); ++c){
+    put_uint(buf, state.lbd[c]);
+    put_uint(buf, state.clause[c].size());
+    for(vector<int>::const_iterator lit=state.clause[c].begin(); lit!=state.clause[c].end(); ++lit)
+      put_uint(buf, *lit > 0 ? 2u*(*lit) : 2u*(-*lit)+1);
+  }
+
+  string tmp_name = string(filename) + ".tmp";
+  FILE *fp = fopen(tmp_name.c_str(), "wb");
+  if(fp == NULL){
+    fprintf(stderr, "ERROR! Could not open checkpoint file: %s\n", tmp_name.c_str());
+    return false;
+  }
+  bool ok = fwrite(&buf[0], 1, buf.size(), fp) == buf.size();
+  ok = fclose(fp) == 0 && ok;
+  if(!ok || rename(tmp_name.c_str(), filename) != 0){
+    fprintf(stderr, "ERROR! Could not write checkpoint file: %s\n", filename);
+    remove(tmp_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+int read_checkpoint(const char *filename, uint64_t hash, int n_var, checkpoint &fill_state){
+  FILE *fp = fopen(filename, "rb");
+  if(fp == NULL)
+    return CHECKPOINT_MISSING;
+  vector<unsigned char> buf;
+  unsigned char chunk[1 << 16];
+  size_t n_read;
+  while((n_read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    buf.insert(buf.end(), chunk, chunk + n_read);
+  fclose(fp);
+
+  if(buf.size() < 16 || memcmp(&buf[0], CHECKPOINT_MAGIC, 8) != 0)
+    return CHECKPOINT_CORRUPT;
+  uint64_t file_hash = 0;
+  for(int i=0; i<8; ++i)
+    file_hash |= uint64_t(buf[8+i]) << (8*i);
+  unsigned pos = 16;
+  unsigned int u;
+  if(!get_uint(buf, pos, u))
+    return CHECKPOINT_CORRUPT;
+  if(file_hash != hash || int(u) != n_var)
+    return CHECKPOINT_OTHER_FORMULA;
+
+  checkpoint state;
+  state.phase.assign(n_var + 1, 0);
+  for(int v=1; v<=n_var; ++v){
+    if(pos >= buf.size() || buf[pos] > 2)
+      return CHECKPOINT_CORRUPT;
+    state.phase[v] = buf[pos] == 0 ? 0 : (buf[pos] == 1 ? v : -v);
+    ++pos;
+  }
+  unsigned int has_rank;
+  if(!get_uint(buf, pos, has_rank))
+    return CHECKPOINT_CORRUPT;
+  if(has_rank)
+    state.rank.assign(n_var + 1, 0);
+  for(int v=1; v<=n_var && has_rank; ++v){
+    if(!get_uint(buf, pos, u) || int(u) >= n_var)
+      return CHECKPOINT_CORRUPT;
+    state.rank[v] = u;
+  }
+  unsigned int n_clause;
+  if(!get_uint(buf, pos, n_clause))
+    return CHECKPOINT_CORRUPT;
+  for(unsigned c=0; c<n_clause; ++c){
+    unsigned int lbd, size;
+    if(!get_uint(buf, pos, lbd) || !get_uint(buf, pos, size) || size == 0 || size > unsigned(n_var))
+      return CHECKPOINT_CORRUPT;
+    state.lbd.push_back(lbd);
+    state.clause.push_back(vector<int>());
+    for(unsigned i=0; i<size; ++i){
+      if(!get_uint(buf, pos, u) || u < 2 || u/2 > unsigned(n_var))
+        return CHECKPOINT_CORRUPT;
+      state.clause.back().push_back(u % 2 ? -int(u/2) : int(u/2));
+    }
+  }
+  if(pos != buf.size())
+    return CHECKPOINT_CORRUPT;
+  fill_state = state;
+  return CHECKPOINT_OK;
+}
@@ -0,0 +1,38 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <stdint.h>
+#include <vector>
+using std::vector;
+
+#define CHECKPOINT_MAGIC "yasatck1"
+#define CHECKPOINT_INTERVAL 60 // sec between two periodic writes
+#define CHECKPOINT_KEEP_LBD 6  // learnt clauses written, besides units and binaries
+
+#define CHECKPOINT_OK 0
+#define CHECKPOINT_MISSING 1
+#define CHECKPOINT_OTHER_FORMULA 2
+#define CHECKPOINT_CORRUPT 3
+
+/* what a run leaves to the next one on the same formula: the good learnt
+ * clauses, a phase and the order of the vars by activity */
+struct checkpoint {
+  vector<int> phase; // by var, the saved literal or 0
+  vector<int> rank;  // by var, 0 for the least active, empty if unknown
+  vector<vector<int> > clause;
+  vector<int> lbd;
+  void keep_learnt(const vector<vector<int> > &, const vector<int> &, int);
+  void rank_activity(const vector<double> &);
+};
+
+/* order dependent hash of the formula as the solver sees it */
+uint64_t formula_hash(const vector<vector<int> > &, int);
+
+/* written to a temporary file renamed over the old one, a kill in between
+ * leaves the previous checkpoint */
+bool write_checkpoint(const char *, uint64_t, int, const checkpoint &);
+
+/* one of CHECKPOINT_OK, MISSING, OTHER_FORMULA or CORRUPT; fills only on OK */
+int read_checkpoint(const char *, uint64_t, int, checkpoint &);
+
+#endif
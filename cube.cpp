@@ -0,0 +1,352 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "drat.h"
+#include "cube.h"
+
+using namespace std;
+
+cube_tree::cube_tree(drat_writer *writer){
+  pthread_mutex_init(&_mutex, NULL);
+  _proof = writer == NULL ? NULL : new drat_buffer(writer);
+  cube_node root;
+  root.parent = -1;
+  root.n_open = 0;
+  root.refuted = false;
+  _nodes.push_back(root);
+}
+
+cube_tree::~cube_tree(){
+  delete _proof;
+  pthread_mutex_destroy(&_mutex);
+}
+
+int cube_tree::add_child(int parent, int lit){
+  pthread_mutex_lock(&_mutex);
+  cube_node child;
+  child.lits = _nodes.at(parent).lits;
+  child.lits.push_back(lit);
+  child.parent = parent;
+  child.n_open = 0;
+  child.refuted = false;
+  _nodes.push_back(child);
+  ++_nodes.at(parent).n_open;
+  int child_idx = _nodes.size() - 1;
+  pthread_mutex_unlock(&_mutex);
+  return child_idx;
+}
+
+bool cube_tree::refute(int node){
+  /* log the negated cube, then refute every ancestor left without open children.
+   * the caller must have flushed the proof lemmas the refutation relies on */
+  pthread_mutex_lock(&_mutex);
+  while(!_nodes.at(node).refuted){
+    cube_node &cur = _nodes.at(node);
+    cur.refuted = true;
+    if(_proof != NULL){
+      vector<int> clause;
+      for(vector<int>::iterator lit=cur.lits.begin(); lit!=cur.lits.end(); ++lit)
+        clause.push_back(-*lit);
+      _proof->add(clause);
+    }
+    if(cur.parent < 0 || _nodes.at(cur.parent).refuted || --_nodes.at(cur.parent).n_open > 0)
+      break;
+    node = cur.parent;
+  }
+  bool root_refuted = _nodes.at(0).refuted;
+  if(root_refuted && _proof != NULL)
+    _proof->flush();
+  pthread_mutex_unlock(&_mutex);
+  return root_refuted;
+}
+
+void cube_tree::add_lemma(const vector<int> &clause){
+  pthread_mutex_lock(&_mutex);
+  if(_proof != NULL)
+    _proof->add(clause);
+  pthread_mutex_unlock(&_mutex);
+}
+
+bool cube_tree::is_refuted(int node){
+  /* a cube is done when it or any cube containing it is refuted */
+  pthread_mutex_lock(&_mutex);
+  bool refuted = false;
+  for(; node >= 0 && !refuted; node = _nodes.at(node).parent)
+    refuted = _nodes.at(node).refuted;
+  pthread_mutex_unlock(&_mutex);
+  return refuted;
+}
+
+void cube_tree::get_lits(int node, vector<int> &fill_lits){
+  pthread_mutex_lock(&_mutex);
+  fill_lits = _nodes.at(node).lits;
+  pthread_mutex_unlock(&_mutex);
+}
+
+void cube_tree::share(const vector<vector<int> > &clauses){
+  pthread_mutex_lock(&_mutex);
+  _shared.insert(_shared.end(), clauses.begin(), clauses.end());
+  pthread_mutex_unlock(&_mutex);
+}
+
+void cube_tree::get_shared(unsigned &cursor, vector<vector<int> > &fill_clauses){
+  /* clauses shared since cursor, cursor moves to the end */
+  pthread_mutex_lock(&_mutex);
+  for(; cursor<_shared.size(); ++cursor)
+    fill_clauses.push_back(_shared.at(cursor));
+  pthread_mutex_unlock(&_mutex);
+}
+
+cube_queue::cube_queue(int n_worker):
+  _deques(n_worker),
+  _mutexes(n_worker){
+  for(int i=0; i<n_worker; ++i)
+    pthread_mutex_init(&_mutexes.at(i), NULL);
+}
+
+cube_queue::~cube_queue(){
+  for(unsigned i=0; i<_mutexes.size(); ++i)
+    pthread_mutex_destroy(&_mutexes.at(i));
+}
+
+void cube_queue::push(int worker, int node){
+  pthread_mutex_lock(&_mutexes.at(worker));
+  _deques.at(worker).push_back(node);
+  pthread_mutex_unlock(&_mutexes.at(worker));
+}
+
+bool cube_queue::pop(int worker, int &fill_node){
+  /* newest own cube first, else steal the oldest (largest) cube of another worker */
+  int n_worker = _deques.size();
+  for(int k=0; k<n_worker; ++k){
+    int victim = (worker + k) % n_worker;
+    bool found = false;
+    pthread_mutex_lock(&_mutexes.at(victim));
+    if(!_deques.at(victim).empty()){
+      found = true;
+      if(k == 0){
+        fill_node = _deques.at(victim).back();
+        _deques.at(victim).pop_back();
+      }
+      else{
+        fill_node = _deques.at(victim).front();
+        _deques.at(victim).pop_front();
+      }
+    }
+    pthread_mutex_unlock(&_mutexes.at(victim));
+    if(found)
+      return true;
+  }
+  return false;
+}
+
+/* unit propagation over the original clauses for the lookahead phase */
+class lookahead {
+public:
+  lookahead(vector<vector<int> > &, int, int);
+  bool ok(){ return _ok; }
+  bool assign(int);
+  int trail_size(){ return _trail.size(); }
+  void backtrack(int);
+  int value(int lit){ return lit > 0 ? _value[lit] : -_value[-lit]; }
+private:
+  static int _lit_idx(int lit){
+    return lit > 0 ? 2*lit : -2*lit+1;
+  }
+  bool _propagate();
+  vector<vector<int> > _clauses;
+  vector<vector<int> > _watches; // by _lit_idx, clauses watching that literal
+  vector<signed char> _value;
+  vector<int> _trail;
+  unsigned _head;
+  bool _ok;
+};
+
+lookahead::lookahead(vector<vector<int> > &clause_db, int max_var_idx, int ori_db_size):
+  _watches(2*max_var_idx + 2),
+  _value(max_var_idx + 1, 0),
+  _head(0),
+  _ok(true){
+  vector<int> units;
+  for(int c=0; c<ori_db_size; ++c){
+    vector<int> clause = clause_db.at(c);
+    sort(clause.begin(), clause.end());
+    clause.erase(unique(clause.begin(), clause.end()), clause.end());
+    bool tautology = false;
+    for(unsigned i=1; i<clause.size(); ++i)
+      if(binary_search(clause.begin(), clause.end(), -clause.at(i)))
+        tautology = true;
+    if(tautology)
+      continue;
+    if(clause.empty())
+      _ok = false;
+    else if(clause.size() == 1)
+      units.push_back(clause.at(0));
+    else{
+      _watches.at(_lit_idx(clause.at(0))).push_back(_clauses.size());
+      _watches.at(_lit_idx(clause.at(1))).push_back(_clauses.size());
+      _clauses.push_back(clause);
+    }
+  }
+  for(vector<int>::iterator lit=units.begin(); lit!=units.end() && _ok; ++lit)
+    _ok = assign(*lit);
+}
+
+bool lookahead::assign(int lit){
+  /* false on conflict; the caller backtracks either way */
+  if(value(lit) != 0)
+    return value(lit) > 0;
+  _value[abs(lit)] = lit > 0 ? 1 : -1;
+  _trail.push_back(lit);
+  return _propagate();
+}
+
+void lookahead::backtrack(int size){
+  while(int(_trail.size()) > size){
+    _value[abs(_trail.back())] = 0;
+    _trail.pop_back();
+  }
+  _head = _trail.size();
+}
+
+bool lookahead::_propagate(){
+  while(_head < _trail.size()){
+    int false_lit = -_trail[_head++];
+    vector<int> &watch = _watches[_lit_idx(false_lit)];
+    unsigned i = 0, j = 0;
+    for(; i<watch.size(); ++i){
+      vector<int> &clause = _clauses[watch[i]];
+      if(clause[0] == false_lit)
+        swap(clause[0], clause[1]);
+      if(value(clause[0]) > 0){
+        watch[j++] = watch[i];
+        continue;
+      }
+      bool moved = false;
+      for(unsigned k=2; k<clause.size(); ++k)
+        if(value(clause[k]) >= 0){
+          swap(clause[1], clause[k]);
+          _watches[_lit_idx(clause[1])].push_back(watch[i]);
+          moved = true;
+          break;
+        }
+      if(moved)
+        continue;
+      watch[j++] = watch[i];
+      if(value(clause[0]) < 0){
+        for(++i; i<watch.size(); ++i)
+          watch[j++] = watch[i];
+        watch.resize(j);
+        _head = _trail.size();
+        return false;
+      }
+      _value[abs(clause[0])] = clause[0] > 0 ? 1 : -1;
+      _trail.push_back(clause[0]);
+    }
+    watch.resize(j);
+  }
+  return true;
+}
+
+static void negate_with(const vector<int> &cube, int lit, vector<int> &fill_clause){
+  /* the clause saying cube implies lit */
+  fill_clause.clear();
+  for(vector<int>::const_iterator it=cube.begin(); it!=cube.end(); ++it)
+    fill_clause.push_back(-*it);
+  fill_clause.push_back(lit);
+}
+
+static void build_node(lookahead &la, vector<int> &order, cube_tree &tree, int node, int depth, int max_depth, vector<int> &leaves){
+  if(depth >= max_depth){
+    leaves.push_back(node);
+    return;
+  }
+  vector<int> cube, lemma;
+  tree.get_lits(node, cube);
+
+  /* probe both phases of the top candidates, fixing failed literals on the way */
+  int best_var = 0;
+  double best_score = -1;
+  int n_candidate = 0;
+  for(vector<int>::iterator vit=order.begin(); vit!=order.end() && n_candidate<LOOKAHEAD_CANDIDATES; ++vit){
+    int var = *vit;
+    if(la.value(var) != 0)
+      continue;
+    ++n_candidate;
+    int base = la.trail_size();
+    bool pos_ok = la.assign(var);
+    int n_pos = la.trail_size() - base;
+    la.backtrack(base);
+    bool neg_ok = la.assign(-var);
+    int n_neg = la.trail_size() - base;
+    la.backtrack(base);
+    if(pos_ok && neg_ok){
+      double score = double(n_pos + 1) * double(n_neg + 1);
+      if(score > best_score){
+        best_score = score;
+        best_var = var;
+      }
+      continue;
+    }
+    int lit = pos_ok ? var : -var;
+    negate_with(cube, lit, lemma);
+    tree.add_lemma(lemma);
+    if(!pos_ok && !neg_ok){
+      negate_with(cube, -lit, lemma);
+      tree.add_lemma(lemma);
+      tree.refute(node);
+      return;
+    }
+    if(!la.assign(lit)){
+      tree.refute(node);
+      return;
+    }
+    best_var = 0; // scores so far are stale
+    best_score = -1;
+  }
+  if(best_var == 0){
+    leaves.push_back(node);
+    return;
+  }
+
+  int child[2];
+  child[0] = tree.add_child(node, best_var);
+  child[1] = tree.add_child(node, -best_var);
+  for(int i=0; i<2; ++i){
+    int base = la.trail_size();
+    if(!la.assign(i == 0 ? best_var : -best_var))
+      tree.refute(child[i]);
+    else
+      build_node(la, order, tree, child[i], depth+1, max_depth, leaves);
+    la.backtrack(base);
+  }
+}
+
+static bool occ_cmp(const pair<int, int> &p1, const pair<int, int> &p2){
+  return p1.first > p2.first;
+}
+
+void build_cubes(vector<vector<int> > &clause_db, int max_var_idx, int ori_db_size, int n_target, cube_tree &tree, vector<int> &leaves){
+  /* split the original formula into about n_target cubes by lookahead */
+  lookahead la(clause_db, max_var_idx, ori_db_size);
+  if(!la.ok()){
+    tree.refute(0);
+    return;
+  }
+  vector<pair<int, int> > occ(max_var_idx + 1);
+  for(int v=0; v<=max_var_idx; ++v)
+    occ.at(v) = make_pair(0, v);
+  for(int c=0; c<ori_db_size; ++c)
+    for(vector<int>::iterator lit=clause_db.at(c).begin(); lit!=clause_db.at(c).end(); ++lit)
+      ++occ.at(abs(*lit)).first;
+  stable_sort(occ.begin() + 1, occ.end(), occ_cmp);
+  vector<int> order;
+  for(int v=1; v<=max_var_idx; ++v)
+    if(occ.at(v).first > 0)
+      order.push_back(occ.at(v).second);
+
+  int max_depth = 0;
+  while((1 << max_depth) < n_target && max_depth < CUBE_MAX_DEPTH)
+    ++max_depth;
+  build_node(la, order, tree, 0, 0, max_depth, leaves);
+}
@@ -0,0 +1,59 @@
+#ifndef _CUBE_H_
+#define _CUBE_H_
+
+#include <pthread.h>
+#include <vector>
+#include <deque>
+using std::vector;
+using std::deque;
+
+#define CUBES_PER_THREAD 8
+#define CUBE_MAX_DEPTH 24
+#define CUBE_CONFLICT_BUDGET 2000
+#define LOOKAHEAD_CANDIDATES 48
+
+class drat_writer;
+class drat_buffer;
+
+struct cube_node {
+  vector<int> lits;
+  int parent; // -1 for the root
+  int n_open; // children not refuted yet
+  bool refuted;
+};
+
+/* the split tree; a node is refuted once its cube is, or both children are.
+ * refuting the root (the empty cube) means the formula is UNSAT */
+class cube_tree {
+public:
+  cube_tree(drat_writer *);
+  ~cube_tree();
+  int add_child(int, int);
+  bool refute(int);
+  void add_lemma(const vector<int> &);
+  bool is_refuted(int);
+  void get_lits(int, vector<int> &);
+  void share(const vector<vector<int> > &);
+  void get_shared(unsigned &, vector<vector<int> > &);
+private:
+  vector<cube_node> _nodes;
+  vector<vector<int> > _shared; // learnt units and binaries of every worker
+  drat_buffer *_proof;
+  pthread_mutex_t _mutex;
+};
+
+/* one deque per worker: owners pop the back, thieves take the front */
+class cube_queue {
+public:
+  cube_queue(int);
+  ~cube_queue();
+  void push(int, int);
+  bool pop(int, int &);
+private:
+  vector<deque<int> > _deques;
+  vector<pthread_mutex_t> _mutexes;
+};
+
+void build_cubes(vector<vector<int> > &, int, int, int, cube_tree &, vector<int> &);
+
+#endif
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include "dedup.h"
+
+clause_filter::clause_filter(int bits):
+  _mask((uint64_t(1) << bits) - 1){
+  _slots = new uint64_t[_mask + 1];
+  std::fill(_slots, _slots + _mask + 1, uint64_t(DEDUP_EMPTY));
+}
+
+clause_filter::~clause_filter(){
+  delete [] _slots;
+}
+
+uint64_t clause_filter::hash(const vector<int> &clause){
+  /* over the sorted literals, so the literal order of a learnt clause does not matter */
+  vector<int> sorted(clause);
+  sort(sorted.begin(), sorted.end());
+  uint64_t h = UINT64_C(0x9e3779b97f4a7c15) ^ sorted.size();
+  for(vector<int>::iterator lit=sorted.begin(); lit!=sorted.end(); ++lit){
+    h ^= uint32_t(*lit);
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+  }
+  h *= UINT64_C(0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+  return h > DEDUP_ERASED ? h : h + 2;
+}
+
+bool clause_filter::insert(const vector<int> &clause){
+  /* true if the clause was not in the set, i.e. the caller should share it */
+  uint64_t h = hash(clause);
+  uint64_t reusable = _mask + 1; // first erased slot of the probe window
+  for(int p=0; p<DEDUP_MAX_PROBES; ++p){
+    uint64_t idx = (h + p) & _mask;
+    uint64_t cur = _slots[idx];
+    if(cur == h)
+      return false;
+    if(cur == DEDUP_ERASED && reusable > _mask)
+      reusable = idx;
+    if(cur != DEDUP_EMPTY)
+      continue;
+    if(reusable <= _mask)
+      break;
+    cur = __sync_val_compare_and_swap(&_slots[idx], uint64_t(DEDUP_EMPTY), h);
+    if(cur == DEDUP_EMPTY)
+      return true;
+    if(cur == h) // another thread exported the same clause just now
+      return false;
+  }
+  if(reusable <= _mask)
+    __sync_bool_compare_and_swap(&_slots[reusable], uint64_t(DEDUP_ERASED), h);
+  return true;
+}
+
+void clause_filter::erase(const vector<int> &clause){
+  /* lets a reduced clause be shared again when it is learnt anew */
+  uint64_t h = hash(clause);
+  for(int p=0; p<DEDUP_MAX_PROBES; ++p){
+    uint64_t idx = (h + p) & _mask;
+    if(_slots[idx] == DEDUP_EMPTY)
+      return;
+    if(__sync_bool_compare_and_swap(&_slots[idx], h, uint64_t(DEDUP_ERASED)))
+      return;
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef _DEDUP_H_
+#define _DEDUP_H_
+
+#include <stdint.h>
+#include <vector>
+using std::vector;
+
+#define DEDUP_TABLE_BITS 20 // 8 MB of slots
+#define DEDUP_MAX_PROBES 16
+#define DEDUP_EMPTY 0
+#define DEDUP_ERASED 1
+
+/* set of 64-bit clause hashes shared by all threads, open addressing
+ * with a bounded linear probe and CAS on the slots, no locks.
+ * a full probe window lets the clause through, a hash collision drops
+ * one; both only cost a little search, never soundness */
+class clause_filter {
+public:
+  clause_filter(int);
+  ~clause_filter();
+  bool insert(const vector<int> &);
+  void erase(const vector<int> &);
+  long bytes(){ return (_mask + 1) * sizeof(uint64_t); }
+  static uint64_t hash(const vector<int> &);
+private:
+  uint64_t *_slots;
+  uint64_t _mask;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include "drat.h"
+
+drat_writer::drat_writer(const char *filename, bool binary):
+  _file_buf(NULL),
+  _binary(binary){
+  pthread_mutex_init(&_mutex, NULL);
+  _fp = fopen(filename, binary ? "wb" : "w");
+  if(_fp == NULL){
+    fprintf(stderr, "ERROR! Could not open proof file: %s\n", filename);
+    return;
+  }
+  _file_buf = new char[DRAT_FILE_BUF_SIZE];
+  setvbuf(_fp, _file_buf, _IOFBF, DRAT_FILE_BUF_SIZE);
+}
+
+drat_writer::~drat_writer(){
+  close();
+  pthread_mutex_destroy(&_mutex);
+}
+
+void drat_writer::write(const vector<unsigned char> &chunk){
+  if(chunk.empty())
+    return;
+  pthread_mutex_lock(&_mutex);
+  if(_fp != NULL)
+    fwrite(&chunk[0], 1, chunk.size(), _fp);
+  pthread_mutex_unlock(&_mutex);
+}
+
+void drat_writer::close(){
+  pthread_mutex_lock(&_mutex);
+  if(_fp != NULL){
+    fclose(_fp);
+    _fp = NULL;
+    delete [] _file_buf;
+    _file_buf = NULL;
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+void drat_buffer::flush(){
+  _writer->write(_buf);
+  _buf.clear();
+}
+
+void drat_buffer::_put_clause(bool is_delete, const vector<int> &clause){
+  if(_writer->is_binary()){
+    _buf.push_back(is_delete ? 'd' : 'a');
+    for(vector<int>::const_iterator lit=clause.begin(); lit!=clause.end(); ++lit)
+      _put_binary_lit(*lit);
+    _buf.push_back(0);
+  }
+  else{
+    if(is_delete){
+      _buf.push_back('d');
+      _buf.push_back(' ');
+    }
+    for(vector<int>::const_iterator lit=clause.begin(); lit!=clause.end(); ++lit)
+      _put_text_lit(*lit);
+    _buf.push_back('0');
+    _buf.push_back('\n');
+  }
+  if(_buf.size() >= DRAT_THREAD_BUF_SIZE)
+    flush();
+}
+
+void drat_buffer::_put_binary_lit(int lit){
+  /* 2*var+sign, 7 bits per byte, least significant first */
+  unsigned int u = lit > 0 ? 2u*lit : 2u*(-lit)+1;
+  while(u > 127){
+    _buf.push_back(128 | (u & 127));
+    u >>= 7;
+  }
+  _buf.push_back(u);
+}
+
+void drat_buffer::_put_text_lit(int lit){
+  char digits[12];
+  int n = 0;
+  unsigned int u = lit > 0 ? lit : -lit;
+  if(lit < 0)
+    _buf.push_back('-');
+  do{
+    digits[n++] = '0' + u % 10;
+    u /= 10;
+  } while(u > 0);
+  while(n > 0)
+    _buf.push_back(digits[--n]);
+  _buf.push_back(' ');
+}
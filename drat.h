@@ -0,0 +1,47 @@
+#ifndef _DRAT_H_
+#define _DRAT_H_
+
+#include <stdio.h>
+#include <pthread.h>
+#include <vector>
+using std::vector;
+
+#define DRAT_FILE_BUF_SIZE (1 << 23)
+#define DRAT_THREAD_BUF_SIZE (1 << 20)
+
+/* shared proof file; every write is one locked chunk from a drat_buffer */
+class drat_writer {
+public:
+  drat_writer(const char *, bool);
+  ~drat_writer();
+  bool is_open(){ return _fp != NULL; }
+  bool is_binary(){ return _binary; }
+  void write(const vector<unsigned char> &);
+  void close();
+private:
+  FILE *_fp;
+  char *_file_buf;
+  bool _binary;
+  pthread_mutex_t _mutex;
+};
+
+/* per thread proof stream, handed to the writer in large chunks.
+ * a thread only derives from the clause_db snapshot it was started with,
+ * and every clause in that snapshot was flushed by its producer before the
+ * producer was joined, so chunks of different threads may interleave freely */
+class drat_buffer {
+public:
+  drat_buffer(drat_writer *w):_writer(w){ _buf.reserve(DRAT_THREAD_BUF_SIZE); }
+  ~drat_buffer(){ flush(); }
+  void add(const vector<int> &clause){ _put_clause(false, clause); }
+  void del(const vector<int> &clause){ _put_clause(true, clause); }
+  void flush();
+private:
+  void _put_clause(bool, const vector<int> &);
+  void _put_binary_lit(int);
+  void _put_text_lit(int);
+  drat_writer *_writer;
+  vector<unsigned char> _buf;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "gauss.h"
+
+using namespace std;
+
+void find_xors(vector<vector<int> > &clause_db, int ori_db_size, vector<xor_constraint> &xors){
+  // sorted vars plus the parity of negations -> sign patterns seen
+  map<vector<int>, vector<char> > patterns;
+  for(int c=0; c<ori_db_size; ++c){
+    vector<int> &clause = clause_db.at(c);
+    int k = clause.size();
+    if(k < 2 || k > XOR_MAX_VARS)
+      continue;
+    vector<pair<int, int> > lits;
+    for(vector<int>::iterator lit=clause.begin(); lit!=clause.end(); ++lit)
+      lits.push_back(make_pair(abs(*lit), *lit < 0));
+    sort(lits.begin(), lits.end());
+    vector<int> key;
+    int pattern = 0, n_neg = 0;
+    for(int i=0; i<k; ++i){
+      if(i > 0 && lits[i].first == lits[i-1].first)
+        break;
+      key.push_back(lits[i].first);
+      if(lits[i].second){
+        pattern |= 1 << i;
+        ++n_neg;
+      }
+    }
+    if(int(key.size()) < k)
+      continue; // repeated var
+    key.push_back(n_neg & 1);
+    vector<char> &seen = patterns[key];
+    if(seen.empty())
+      seen.assign(1 << k, 0);
+    seen.at(pattern) = 1;
+  }
+  for(map<vector<int>, vector<char> >::iterator it=patterns.begin(); it!=patterns.end(); ++it){
+    int k = it->first.size() - 1;
+    if(count(it->second.begin(), it->second.end(), 1) < (1 << (k-1)))
+      continue;
+    /* each clause forbids one assignment of the other parity */
+    xor_constraint x;
+    x.vars.assign(it->first.begin(), it->first.end() - 1);
+    x.rhs = !it->first.back();
+    xors.push_back(x);
+  }
+}
+
+gauss_matrix::gauss_matrix(const vector<xor_constraint> &xors, int max_var_idx):
+  _n_row(xors.size()),
+  _check_all(true),
+  _consistent(true){
+  _var_col.assign(max_var_idx + 1, -1);
+  for(vector<xor_constraint>::const_iterator x=xors.begin(); x!=xors.end(); ++x)
+    for(vector<int>::const_iterator v=x->vars.begin(); v!=x->vars.end(); ++v)
+      if(_var_col.at(*v) < 0){
+        _var_col.at(*v) = _col_var.size();
+        _col_var.push_back(*v);
+      }
+  _n_word = max(1, int(_col_var.size() + 63) / 64);
+  _bits.assign(_n_row * _n_word, 0);
+  _rhs.assign(_n_row, 0);
+  for(int r=0; r<_n_row; ++r){
+    for(vector<int>::const_iterator v=xors.at(r).vars.begin(); v!=xors.at(r).vars.end(); ++v){
+      int col = _var_col.at(*v);
+      _row(r)[col >> 6] ^= uint64_t(1) << (col & 63);
+    }
+    _rhs.at(r) = xors.at(r).rhs;
+  }
+
+  /* reduced row echelon form; dependent rows vanish, or prove UNSAT */
+  _basic.assign(_n_row, -1);
+  _basic_row.assign(_col_var.size(), -1);
+  _dirty.assign(_n_row, 0);
+  _unassigned.assign(_n_word, ~uint64_t(0));
+  for(int r=0; r<_n_row; ++r){
+    int col = _first_unassigned(r);
+    if(col >= 0)
+      _pivot(r, col);
+    else if(_rhs.at(r))
+      _consistent = false;
+  }
+  int n_kept = 0;
+  for(int r=0; r<_n_row; ++r){
+    if(_basic.at(r) < 0)
+      continue;
+    copy(_row(r), _row(r) + _n_word, _row(n_kept));
+    _rhs.at(n_kept) = _rhs.at(r);
+    _basic.at(n_kept) = _basic.at(r);
+    _basic_row.at(_basic.at(r)) = n_kept;
+    ++n_kept;
+  }
+  _n_row = n_kept;
+  _bits.resize(_n_row * _n_word);
+  _rhs.resize(_n_row);
+  _basic.resize(_n_row);
+  _dirty.assign(_n_row, 0);
+  reset();
+}
+
+void gauss_matrix::reset(){
+  _unassigned.assign(_n_word, 0);
+  for(unsigned col=0; col<_col_var.size(); ++col)
+    _unassigned[col >> 6] |= uint64_t(1) << (col & 63);
+  _true.assign(_n_word, 0);
+  _pending.clear();
+  _check_all = true;
+}
+
+void gauss_matrix::assign(int var, bool value){
+  int col = _var_col[var];
+  if(col < 0)
+    return;
+  _unassigned[col >> 6] &= ~(uint64_t(1) << (col & 63));
+  if(value)
+    _true[col >> 6] |= uint64_t(1) << (col & 63);
+  _pending.push_back(col);
+}
+
+void gauss_matrix::unassign(int var){
+  int col = _var_col[var];
+  if(col < 0)
+    return;
+  _unassigned[col >> 6] |= uint64_t(1) << (col & 63);
+  _true[col >> 6] &= ~(uint64_t(1) << (col & 63));
+}
+
+bool gauss_matrix::propagate(vector<int> &implied, vector<vector<int> > &reason, vector<int> &conflict){
+  /* re-pivot rows whose basic var got assigned, then check the rows touched.
+   * false on a conflict, with every literal of conflict false */
+  for(vector<int>::iterator col=_pending.begin(); col!=_pending.end(); ++col){
+    int r = _basic_row.at(*col);
+    if(r >= 0){
+      int u = _first_unassigned(r);
+      if(u >= 0)
+        _pivot(r, u);
+    }
+    for(int r2=0; r2<_n_row; ++r2)
+      if(_has(_row(r2), *col))
+        _dirty[r2] = 1;
+  }
+  _pending.clear();
+  if(_check_all){
+    /* after a backtrack, rows left on an assigned basic var may have open vars again */
+    for(int r=0; r<_n_row; ++r){
+      if(_has(&_unassigned[0], _basic[r]))
+        continue;
+      int u = _first_unassigned(r);
+      if(u >= 0)
+        _pivot(r, u);
+    }
+    _dirty.assign(_n_row, 1);
+    _check_all = false;
+  }
+  for(int r=0; r<_n_row; ++r){
+    if(!_dirty[r])
+      continue;
+    _dirty[r] = 0;
+    int n_unassigned = _count_unassigned(r);
+    if(n_unassigned == 0 && _parity_of_true(r) != bool(_rhs[r])){
+      _row_clause(r, -1, false, conflict);
+      _check_all = true; // the rows left unchecked
+      return false;
+    }
+    if(n_unassigned == 1){
+      int u = _first_unassigned(r);
+      bool value = bool(_rhs[r]) != _parity_of_true(r);
+      implied.push_back(value ? _col_var[u] : -_col_var[u]);
+      reason.push_back(vector<int>());
+      _row_clause(r, u, value, reason.back());
+    }
+  }
+  return true;
+}
+
+void gauss_matrix::_pivot(int r, int col){
+  /* make col the basic column of row r, clearing it from every other row */
+  if(_basic[r] >= 0)
+    _basic_row[_basic[r]] = -1;
+  _basic[r] = col;
+  _basic_row[col] = r;
+  const uint64_t *src = _row(r);
+  for(int r2=0; r2<_n_row; ++r2){
+    uint64_t *dst = _row(r2);
+    if(r2 == r || !_has(dst, col))
+      continue;
+    for(int w=0; w<_n_word; ++w)
+      dst[w] ^= src[w];
+    _rhs[r2] ^= _rhs[r];
+    _dirty[r2] = 1;
+  }
+  _dirty[r] = 1;
+}
+
+int gauss_matrix::_first_unassigned(int r){
+  const uint64_t *bits = _row(r);
+  for(int w=0; w<_n_word; ++w){
+    uint64_t open = bits[w] & _unassigned[w];
+    if(open)
+      return (w << 6) + __builtin_ctzll(open);
+  }
+  return -1;
+}
+
+int gauss_matrix::_count_unassigned(int r){
+  /* exact up to 2, which is all the callers need */
+  const uint64_t *bits = _row(r);
+  int n = 0;
+  for(int w=0; w<_n_word && n<2; ++w)
+    n += __builtin_popcountll(bits[w] & _unassigned[w]);
+  return n;
+}
+
+bool gauss_matrix::_parity_of_true(int r){
+  const uint64_t *bits = _row(r);
+  int n = 0;
+  for(int w=0; w<_n_word; ++w)
+    n += __builtin_popcountll(bits[w] & _true[w]);
+  return n & 1;
+}
+
+void gauss_matrix::_row_clause(int r, int implied_col, bool value, vector<int> &clause){
+  /* the row as a clause: the implied literal, or nothing on a conflict,
+   * plus every other var of the row at the opposite of its value */
+  const uint64_t *bits = _row(r);
+  for(int w=0; w<_n_word; ++w)
+    for(uint64_t rest=bits[w]; rest; rest&=rest-1){
+      int col = (w << 6) + __builtin_ctzll(rest);
+      int var = _col_var[col];
+      if(col == implied_col)
+        clause.push_back(value ? var : -var);
+      else
+        clause.push_back(_has(&_true[0], col) ? -var : var);
+    }
+}
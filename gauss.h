@@ -0,0 +1,59 @@
+#ifndef _GAUSS_H_
+#define _GAUSS_H_
+
+#include <stdint.h>
+#include <vector>
+using std::vector;
+
+#define XOR_MAX_VARS 5 // a k-var xor takes 2^(k-1) clauses
+
+struct xor_constraint {
+  vector<int> vars; // sorted, positive
+  bool rhs;         // the vars xor to rhs
+};
+
+/* xors encoded as complete sets of clauses over the same vars,
+ * i.e. all 2^(k-1) sign patterns with the same parity of negations */
+void find_xors(vector<vector<int> > &, int, vector<xor_constraint> &);
+
+/* the xor system as packed bit rows kept in reduced row echelon form.
+ * every row has a basic column found in no other row; when the basic var
+ * gets assigned the row pivots onto an unassigned one, so a row with a
+ * single unassigned var is an implication and a fully assigned row with
+ * the wrong parity a conflict. row operations are equivalences, so
+ * backtracking only needs the assignment masks restored */
+class gauss_matrix {
+public:
+  gauss_matrix(const vector<xor_constraint> &, int);
+  bool consistent(){ return _consistent; }
+  void reset();
+  void assign(int, bool);
+  void unassign(int);
+  void recheck_all(){ _check_all = true; }
+  bool has_work(){ return _check_all || !_pending.empty(); }
+  bool propagate(vector<int> &, vector<vector<int> > &, vector<int> &);
+private:
+  uint64_t *_row(int r){ return &_bits[r * _n_word]; }
+  bool _has(const uint64_t *bits, int col){ return bits[col >> 6] >> (col & 63) & 1; }
+  void _pivot(int, int);
+  int _first_unassigned(int);
+  int _count_unassigned(int);
+  bool _parity_of_true(int);
+  void _row_clause(int, int, bool, vector<int> &);
+  int _n_row;
+  int _n_word;
+  vector<uint64_t> _bits;  // row major, _n_word words per row
+  vector<char> _rhs;
+  vector<int> _basic;      // basic column of each row
+  vector<int> _basic_row;  // row of each basic column, -1 otherwise
+  vector<int> _col_var;
+  vector<int> _var_col;    // -1 for vars in no xor
+  vector<uint64_t> _unassigned;
+  vector<uint64_t> _true;
+  vector<int> _pending;    // columns assigned since the last propagate
+  vector<char> _dirty;     // rows to check
+  bool _check_all;
+  bool _consistent;
+};
+
+#endif
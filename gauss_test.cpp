@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "gauss.h"
+
+using namespace std;
+
+/* gauss_matrix against brute force over small xor systems: at every
+ * fixpoint of assign, propagate and backtrack the matrix must have found
+ * each implied var, and report a conflict exactly when there is one */
+
+#define N_VAR 8
+#define N_ROUND 20000
+
+static int n_fail = 0;
+
+static void fail(const char *what, int round){
+  if(++n_fail <= 10)
+    printf("FAIL round %d: %s\n", round, what);
+}
+
+static bool satisfies(const vector<xor_constraint> &xors, int bits){
+  for(unsigned x=0; x<xors.size(); ++x){
+    bool parity = false;
+    for(unsigned v=0; v<xors[x].vars.size(); ++v)
+      parity ^= bits >> xors[x].vars[v] & 1;
+    if(parity != xors[x].rhs)
+      return false;
+  }
+  return true;
+}
+
+/* -1 if no completion of value satisfies every xor, else the number of
+ * unassigned vars that take the same value in all completions */
+static int n_forced(const vector<xor_constraint> &xors, const vector<int> &value){
+  int can_true = 0, can_false = 0;
+  bool any = false;
+  for(int bits=0; bits<(1 << (N_VAR + 1)); bits+=2){
+    bool fits = true;
+    for(int v=1; v<=N_VAR && fits; ++v)
+      fits = value[v] == 0 || (value[v] > 0) == bool(bits >> v & 1);
+    if(!fits || !satisfies(xors, bits))
+      continue;
+    any = true;
+    can_true |= bits;
+    can_false |= ~bits;
+  }
+  if(!any)
+    return -1;
+  int n = 0;
+  for(int v=1; v<=N_VAR; ++v)
+    if(value[v] == 0 && !((can_true >> v & 1) && (can_false >> v & 1)))
+      ++n;
+  return n;
+}
+
+static bool fixpoint(gauss_matrix &gauss, vector<int> &value, vector<int> &level, int cur_level){
+  /* false on a conflict */
+  while(gauss.has_work()){
+    vector<int> implied, conflict;
+    vector<vector<int> > reason;
+    if(!gauss.propagate(implied, reason, conflict))
+      return false;
+    for(unsigned i=0; i<implied.size(); ++i){
+      int var = abs(implied[i]);
+      if(value[var] == -implied[i])
+        return false;
+      if(value[var] != 0)
+        continue;
+      value[var] = implied[i];
+      level[var] = cur_level;
+      gauss.assign(var, implied[i] > 0);
+    }
+  }
+  return true;
+}
+
+static void stale_pivot(){
+  /* x1 ^ x2 = 0 ends up with x2 as its basic var, and x2 stays assigned
+   * while x1 is backtracked: the row must pivot onto x1 and imply it */
+  vector<xor_constraint> xors(2);
+  int vars[2][3] = {{1, 2}, {1, 3, 4}};
+  for(int x=0; x<2; ++x){
+    xors[x].vars.assign(vars[x], vars[x] + 2 + x);
+    xors[x].rhs = 0;
+  }
+  gauss_matrix gauss(xors, 4);
+  vector<int> implied, conflict;
+  vector<vector<int> > reason;
+  gauss.propagate(implied, reason, conflict);
+  gauss.assign(1, false);
+  gauss.assign(2, false);
+  gauss.propagate(implied, reason, conflict);
+  gauss.unassign(1);
+  gauss.recheck_all();
+  implied.clear();
+  if(!gauss.propagate(implied, reason, conflict) || implied.size() != 1 || implied[0] != -1)
+    fail("x1 not implied by a row whose basic var stayed assigned", 0);
+}
+
+int main(){
+  stale_pivot();
+  srand(1);
+  for(int round=1; round<=N_ROUND; ++round){
+    vector<xor_constraint> xors(1 + rand() % 5);
+    for(unsigned x=0; x<xors.size(); ++x){
+      for(int v=1; v<=N_VAR; ++v)
+        if(rand() % 3 == 0)
+          xors[x].vars.push_back(v);
+      if(xors[x].vars.empty())
+        xors[x].vars.push_back(1 + rand() % N_VAR);
+      xors[x].rhs = rand() % 2;
+    }
+    gauss_matrix gauss(xors, N_VAR);
+    if(!gauss.consistent()){
+      if(n_forced(xors, vector<int>(N_VAR + 1, 0)) >= 0)
+        fail("inconsistent system with a solution", round);
+      continue;
+    }
+    vector<int> value(N_VAR + 1, 0), level(N_VAR + 1, 0);
+    int cur_level = 0;
+    for(int step=0; step<12; ++step){
+      if(cur_level > 0 && rand() % 3 == 0){
+        /* backtrack to a random level, as the solver does */
+        cur_level = rand() % cur_level;
+        for(int v=1; v<=N_VAR; ++v)
+          if(value[v] != 0 && level[v] > cur_level){
+            value[v] = 0;
+            gauss.unassign(v);
+          }
+        gauss.recheck_all();
+      }
+      else{
+        /* a few vars at once, some below the new level as chronological
+         * backtracking and late units leave them */
+        ++cur_level;
+        for(int n=1+rand()%3; n>0; --n){
+          int var = 1 + rand() % N_VAR;
+          if(value[var] != 0)
+            continue;
+          value[var] = rand() % 2 ? var : -var;
+          level[var] = rand() % 2 ? cur_level : rand() % cur_level;
+          gauss.assign(var, value[var] > 0);
+        }
+      }
+      bool consistent = fixpoint(gauss, value, level, cur_level);
+      int forced = n_forced(xors, value);
+      if(!consistent && forced >= 0)
+        fail("conflict without one", round);
+      if(consistent && forced < 0)
+        fail("missed conflict", round);
+      if(consistent && forced > 0)
+        fail("missed implication", round);
+      if(!consistent){
+        for(int v=1; v<=N_VAR; ++v)
+          if(value[v] != 0)
+            gauss.unassign(v);
+        value.assign(N_VAR + 1, 0);
+        cur_level = 0;
+        gauss.recheck_all();
+        fixpoint(gauss, value, level, cur_level);
+      }
+    }
+  }
+  printf("%s, %d failures\n", n_fail ? "FAILED" : "passed", n_fail);
+  return n_fail ? 1 : 0;
+}
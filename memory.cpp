@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <unistd.h>
+#include "memory.h"
+
+mem_governor::mem_governor(long budget, int n_slot):
+  _budget(budget),
+  _bytes(n_slot, 0),
+  _used(0),
+  _pressure(MEM_OK){
+  pthread_mutex_init(&_mutex, NULL);
+  _last_update.tv_sec = 0;
+  _last_update.tv_nsec = 0;
+}
+
+mem_governor::~mem_governor(){
+  pthread_mutex_destroy(&_mutex);
+}
+
+void mem_governor::report(int slot, long bytes){
+  __sync_lock_test_and_set(&_bytes.at(slot), bytes);
+}
+
+int mem_governor::pressure(){
+  /* refreshed by whichever thread asks first after the interval */
+  if(!enabled())
+    return MEM_OK;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed = now.tv_sec - _last_update.tv_sec + double(now.tv_nsec - _last_update.tv_nsec) / 1e9;
+  if(elapsed >= MEM_UPDATE_INTERVAL && pthread_mutex_trylock(&_mutex) == 0){
+    _last_update = now;
+    _update();
+    pthread_mutex_unlock(&_mutex);
+  }
+  return __sync_fetch_and_add(&_pressure, 0);
+}
+
+long mem_governor::rss_bytes(){
+  long size = 0, resident = 0;
+  FILE *fp = fopen("/proc/self/statm", "r");
+  if(fp == NULL)
+    return 0;
+  if(fscanf(fp, "%ld %ld", &size, &resident) != 2)
+    resident = 0;
+  fclose(fp);
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+long mem_governor::clause_bytes(const vector<int> &clause){
+  return sizeof(vector<int>) + clause.capacity() * sizeof(int);
+}
+
+void mem_governor::_update(){
+  long tracked = 0;
+  for(unsigned i=0; i<_bytes.size(); ++i)
+    tracked += __sync_fetch_and_add(&_bytes[i], 0);
+  long rss = rss_bytes();
+  _used = rss > tracked ? rss : tracked;
+  int level = MEM_OK;
+  if(_used >= MEM_CRITICAL_RATIO * _budget)
+    level = MEM_CRITICAL;
+  else if(_used >= MEM_HIGH_RATIO * _budget)
+    level = MEM_HIGH;
+  __sync_lock_test_and_set(&_pressure, level);
+}
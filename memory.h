@@ -0,0 +1,40 @@
+#ifndef _MEMORY_H_
+#define _MEMORY_H_
+
+#include <time.h>
+#include <pthread.h>
+#include <vector>
+using std::vector;
+
+#define MEM_OK 0
+#define MEM_HIGH 1     // reduce learnt clauses, share only the good ones
+#define MEM_CRITICAL 2 // also shed portfolio workers
+
+#define MEM_HIGH_RATIO 0.8
+#define MEM_CRITICAL_RATIO 0.95
+#define MEM_UPDATE_INTERVAL 0.1 // sec between two RSS reads
+#define MEM_KEEP_LBD 2          // learnt clauses kept on reduction, besides binaries
+
+/* tracks the clause memory of every thread and the process RSS against a
+ * byte budget. a budget of 0 disables it and pressure() stays MEM_OK */
+class mem_governor {
+public:
+  mem_governor(long, int);
+  ~mem_governor();
+  bool enabled(){ return _budget > 0; }
+  void report(int, long);
+  int pressure();
+  long used(){ return _used; }
+  static long rss_bytes();
+  static long clause_bytes(const vector<int> &);
+private:
+  void _update();
+  long _budget;
+  vector<long> _bytes; // per slot: one per thread plus the shared clause_db
+  long _used;
+  int _pressure;
+  struct timespec _last_update;
+  pthread_mutex_t _mutex;
+};
+
+#endif
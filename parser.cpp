@@ -55,14 +55,16 @@ void skipLine(StreamBuffer &in) {
 }
 
 
-int parseInt(StreamBuffer &in) {
+int parseInt(StreamBuffer &in, bool &ok) {
   int     val = 0;
   bool    neg = false;
   skipWhitespace(in);
   if      (*in == '-') neg = true, ++in;
   else if (*in == '+') ++in;
-  if (*in < '0' || *in > '9')
-    fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+  if (*in < '0' || *in > '9') {
+    ok = false;
+    return 0;
+  }
   while (*in >= '0' && *in <= '9') {
     val = val*10 + (*in - '0');
     ++in;
@@ -71,11 +73,12 @@ int parseInt(StreamBuffer &in) {
 }
 
 
-void readClause(StreamBuffer &in, vector<vector<int> > &clauses) {
+void readClause(StreamBuffer &in, vector<vector<int> > &clauses, bool &ok) {
   int parsed_lit;
   vector<int> newClause;
   while (true) {
-    parsed_lit = parseInt(in);
+    parsed_lit = parseInt(in, ok);
+    if (!ok) return;
     if (parsed_lit == 0) break;
     newClause.push_back(parsed_lit);
   }
@@ -83,29 +86,64 @@ void readClause(StreamBuffer &in, vector<vector<int> > &clauses) {
 }
 
 
-void parse_DIMACS_main(StreamBuffer &in, vector<vector<int> > &clauses) {
-  while (true) {
+// the <vars> of a "p cnf <vars> <clauses>" line, -1 if it has none
+int readHeader(StreamBuffer &in) {
+  ++in;
+  while (*in == ' ' || *in == '\t') ++in;
+  while (*in != EOF && *in != ' ' && *in != '\t' && *in != '\n') ++in;
+  while (*in == ' ' || *in == '\t') ++in;
+  int vars = -1;
+  if (*in >= '0' && *in <= '9') {
+    bool ok = true;
+    vars = parseInt(in, ok);
+  }
+  skipLine(in);
+  return vars;
+}
+
+
+// false with `in' at the unexpected char
+bool parse_DIMACS_main(StreamBuffer &in, vector<vector<int> > &clauses,
+		       int &headerVars) {
+  bool ok = true;
+  headerVars = -1;
+  while (ok) {
     skipWhitespace(in);
     if (*in == EOF) break;
-    else if (*in == 'c' || *in == 'p') skipLine(in);
-    else readClause(in, clauses);
+    else if (*in == 'c') skipLine(in);
+    else if (*in == 'p') headerVars = readHeader(in);
+    else readClause(in, clauses, ok);
   }
+  return ok;
 }
 
 
 //void parse_DIMACS(gzFile input_stream, vector<vector<int> > &clauses)
-void parse_DIMACS(FILE *input_stream, vector<vector<int> > &clauses)
+void parse_DIMACS(FILE *input_stream, vector<vector<int> > &clauses,
+		  int &headerVars)
 {
   StreamBuffer in(input_stream);
-  parse_DIMACS_main(in, clauses);
+  if (!parse_DIMACS_main(in, clauses, headerVars))
+    fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+}
+
+
+void findMaxVarIndex(const vector<vector<int> > &clauses, int &maxVarIndex) {
+  unsigned int i, j;
+  int candidate;
+  maxVarIndex = 0;
+  for (i = 0; i < clauses.size(); ++i)
+    for (j = 0; j < clauses[i].size(); ++j) {
+      candidate = abs(clauses[i][j]);
+      if (candidate > maxVarIndex) maxVarIndex = candidate;
+    }
 }
 
 
 void parse_DIMACS_CNF(vector<vector<int> > &clauses,
 		      int &maxVarIndex,
+		      int &headerVars,
 		      const char *DIMACS_cnf_file) {
-  unsigned int i, j;
-  int candidate;
   //gzFile in = gzopen(DIMACS_cnf_file, "rb");
   FILE *in = fopen(DIMACS_cnf_file, "r");
   if (in == NULL) {
@@ -113,15 +151,28 @@ void parse_DIMACS_CNF(vector<vector<int> > &clauses,
 	    DIMACS_cnf_file);
     exit(1);
   }
-  parse_DIMACS(in, clauses);
+  parse_DIMACS(in, clauses, headerVars);
   //gzclose(in);
   fclose(in);
+  findMaxVarIndex(clauses, maxVarIndex);
+}
 
+
+bool parse_DIMACS_buffer(vector<vector<int> > &clauses,
+			 int &maxVarIndex,
+			 int &headerVars,
+			 const char *data,
+			 size_t size) {
   maxVarIndex = 0;
-  for (i = 0; i < clauses.size(); ++i)
-    for (j = 0; j < clauses[i].size(); ++j) {
-      candidate = abs(clauses[i][j]);
-      if (candidate > maxVarIndex) maxVarIndex = candidate;
-    }
+  headerVars = -1;
+  if (size == 0) return true;
+  FILE *in = fmemopen(const_cast<char *>(data), size, "r");
+  if (in == NULL) return false;
+  StreamBuffer *buffered = new StreamBuffer(in); // too large for a small thread stack
+  bool ok = parse_DIMACS_main(*buffered, clauses, headerVars);
+  delete buffered;
+  fclose(in);
+  findMaxVarIndex(clauses, maxVarIndex);
+  return ok;
 }
 
@@ -8,6 +8,7 @@
 
 #ifndef __PARSER_H__
 #  define __PARSER_H__
+#include <stddef.h>
 #include <vector>
 using std::vector;
 
@@ -23,12 +24,13 @@ using std::vector;
 //
 // // Parse the CNF file "benchmark.cnf"
 // vector<vector<int> > clauses;
-// int maxVarIndex;
-// parse_DIMACS_CNF(clauses, maxVarIndex, "benchmark.cnf");
+// int maxVarIndex, headerVars;
+// parse_DIMACS_CNF(clauses, maxVarIndex, headerVars, "benchmark.cnf");
 //
-// // Now the `clauses' structure holds the clause database, and
+// // Now the `clauses' structure holds the clause database,
 // // `maxVarIndex' is equal to the largest variable index appearing
-// // in the input CNF file.
+// // in the input CNF file, and `headerVars' is the var count of its
+// // `p cnf' line, -1 without one.
 //
 //
 // You can refer to the ith clause appearing in the CNF file using the
@@ -37,9 +39,22 @@ using std::vector;
 // tells you the number of clauses in the benchmark.
 void parse_DIMACS_CNF(vector<vector<int> > &clauses,
 		      int &maxVarIndex,
+		      int &headerVars,
 		      const char *DIMACS_cnf_file);
 
 
+// parse_DIMACS_buffer
+//
+// The same for a DIMACS text of `size' bytes held in memory at `data',
+// for callers that cannot exit on bad input.  Returns false if the text
+// is not valid DIMACS, `clauses' then holds the clauses before the error.
+bool parse_DIMACS_buffer(vector<vector<int> > &clauses,
+			 int &maxVarIndex,
+			 int &headerVars,
+			 const char *data,
+			 size_t size);
+
+
 
 
 
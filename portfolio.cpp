@@ -0,0 +1,80 @@
+#include <math.h>
+#include <algorithm>
+#include "branch.h"
+#include "portfolio.h"
+
+using namespace std;
+
+static const int decay[][2] = {{128, 256}, {16, 32}, {1, 2}};
+static const int restart_chance[] = {1000000, 0};
+
+portfolio::portfolio(int branch):
+  _total(0){
+  /* the schedule's random branch decays and restarts on or off, crossed
+   * with every heuristic when the threads may mix them */
+  int first_branch = branch == BRANCH_MIX ? 0 : branch;
+  int last_branch = branch == BRANCH_MIX ? BRANCH_MIX - 1 : branch;
+  for(int b=first_branch; b<=last_branch; ++b)
+    for(int r=0; r<2; ++r)
+      for(int d=0; d<3; ++d){
+        strategy s;
+        s.restart_chance = restart_chance[r];
+        s.numerator = decay[d][0];
+        s.denominator = decay[d][1];
+        s.branch = b;
+        _arms.push_back(s);
+      }
+  _reward.assign(_arms.size(), 0);
+  _count.assign(_arms.size(), 0);
+}
+
+void portfolio::assign(int n_worker, vector<int> &fill_arm){
+  /* untried arms first, ties to the lowest index */
+  vector<double> count(_count);
+  double total = _total;
+  fill_arm.assign(n_worker, 0);
+  for(int w=0; w<n_worker; ++w){
+    int best = -1;
+    double best_bound = 0;
+    for(int a=0; a<n_arm(); ++a){
+      if(count[a] <= 0){
+        best = a;
+        break;
+      }
+      double mean = _reward[a] / max(_count[a], 1e-9);
+      double bound = mean + PORTFOLIO_EXPLORE * sqrt(2 * log(max(total, 1.0)) / count[a]);
+      if(best < 0 || bound > best_bound){
+        best = a;
+        best_bound = bound;
+      }
+    }
+    fill_arm[w] = best;
+    count[best] += 1;
+    total += 1;
+  }
+}
+
+void portfolio::update(const vector<int> &arm, const vector<worker_progress> &progress){
+  /* reward: trail, share of good clauses and conflicts per assignment,
+   * the first and last against the best thread of the round */
+  int max_trail = 1;
+  double max_rate = 1e-9;
+  for(unsigned w=0; w<progress.size(); ++w){
+    max_trail = max(max_trail, progress[w].best_trail);
+    max_rate = max(max_rate, double(progress[w].n_conflict) / max(progress[w].n_assign, 1L));
+  }
+  for(int a=0; a<n_arm(); ++a){
+    _reward[a] *= PORTFOLIO_DISCOUNT;
+    _count[a] *= PORTFOLIO_DISCOUNT;
+  }
+  _total *= PORTFOLIO_DISCOUNT;
+  for(unsigned w=0; w<progress.size(); ++w){
+    const worker_progress &p = progress[w];
+    double trail = double(p.best_trail) / max_trail;
+    double good = p.n_learnt > 0 ? double(p.n_good) / p.n_learnt : 0;
+    double rate = double(p.n_conflict) / max(p.n_assign, 1L) / max_rate;
+    _reward[arm.at(w)] += (trail + good + rate) / 3;
+    _count[arm.at(w)] += 1;
+    _total += 1;
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef _PORTFOLIO_H_
+#define _PORTFOLIO_H_
+
+#include <vector>
+using std::vector;
+
+#define PORTFOLIO_FIXED 0  // every learner on the shared annealing schedule
+#define PORTFOLIO_BANDIT 1 // learners moved to the strategies doing best
+
+#define PORTFOLIO_EXPLORE 0.5  // ucb exploration weight, rewards are in [0,1]
+#define PORTFOLIO_DISCOUNT 0.9 // per round, old rewards fade as the search moves on
+#define PORTFOLIO_GOOD_LBD 6   // learnt clauses at most this glue count as useful
+
+/* the settings a learn thread runs one round with */
+struct strategy {
+  int restart_chance;
+  int numerator;   // random branch chance numerator/denominator,
+  int denominator; // the denominator grows every restart
+  int branch;
+};
+
+/* what a learn thread did in one round, all of it counted in work rather
+ * than time so deterministic runs pick the same arms */
+struct worker_progress {
+  int best_trail;
+  int n_learnt; // exported after dedup
+  int n_good;   // of those, glue at most PORTFOLIO_GOOD_LBD
+  long n_conflict;
+  long n_assign;
+};
+
+/* discounted ucb1 over a fixed set of strategies. every round the learn
+ * threads are respawned on the arms with the best bound, spread out by
+ * counting each pick before the next; their progress, scaled against the
+ * best thread of the round, is the reward */
+class portfolio {
+public:
+  portfolio(int);
+  int n_arm(){ return _arms.size(); }
+  const strategy &arm(int a){ return _arms.at(a); }
+  void assign(int, vector<int> &);
+  void update(const vector<int> &, const vector<worker_progress> &);
+private:
+  vector<strategy> _arms;
+  vector<double> _reward; // discounted sums
+  vector<double> _count;  // discounted pulls
+  double _total;
+};
+
+#endif
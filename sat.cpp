@@ -3,14 +3,29 @@
 #include <string.h>
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <vector>
-#include <map>
 #include <deque>
 #include <iostream>
 #include <fstream>
 #include <pthread.h>
+#include <signal.h>
 #include <unistd.h>
 #include "parser.h"
+#include "drat.h"
+#include "sls.h"
+#include "cube.h"
+#include "memory.h"
+#include "dedup.h"
+#include "simd.h"
+#include "symmetry.h"
+#include "gauss.h"
+#include "amo.h"
+#include "branch.h"
+#include "checkpoint.h"
+#include "server.h"
+#include "trace.h"
+#include "portfolio.h"
 #include "sat.h"
 
 using namespace std;
@@ -27,21 +42,145 @@ sat::sat(vector<vector<int> > &clause_db, int maxVarIndex, int ori_db_size, int
   _learnt_size_limit(1),
   _n_conflict_to_restart(100),
   _n_conflict_to_restart_bound(100),
-  _has_add_clause(false){
+  _has_add_clause(false),
+  _proof(NULL),
+  _governor(NULL),
+  _governor_slot(0),
+  _gauss(NULL),
+  _chrono(0),
+  _best_trail(0),
+  _n_conflicts(0),
+  _n_decisions(0),
+  _n_assigns(0),
+  _enumerating(false),
+  _assump_level(0){
 
+  _decider = _phase_decider[0] = _phase_decider[1] = new_decider(BRANCH_VSIDS, _value);
   /* init randomness hyper-parameters of simulated annealing */
   _init();
   _transfered_db_size = _clause_db.size();
+  _clause_bytes = 0;
+  for(vector<vector<int> >::iterator cit=_clause_db.begin(); cit!=_clause_db.end(); ++cit){
+    _clause_lbd.push_back(cit->size());
+    _clause_bytes += mem_governor::clause_bytes(*cit);
+  }
+}
+
+sat::~sat(){
+  delete _proof;
+  delete _gauss;
+  if(_phase_decider[1] != _phase_decider[0])
+    delete _phase_decider[1];
+  delete _phase_decider[0];
+}
+
+void sat::set_proof(drat_writer *writer){
+  /* log learnt clauses of this solver into writer */
+  delete _proof;
+  _proof = writer == NULL ? NULL : new drat_buffer(writer);
+}
+
+void sat::set_governor(mem_governor *governor, int slot){
+  /* report clause memory to governor and shrink the learnt clauses under pressure */
+  _governor = governor;
+  _governor_slot = slot;
+  if(_governor != NULL)
+    _governor->report(_governor_slot, _clause_bytes);
+}
+
+void sat::set_gauss(const gauss_matrix *gauss){
+  /* propagate the xors of gauss next to the clauses, on a private copy */
+  delete _gauss;
+  _gauss = gauss == NULL ? NULL : new gauss_matrix(*gauss);
+  if(_gauss != NULL)
+    _gauss->reset();
+}
+
+void sat::set_amo(const vector<vector<int> > *groups){
+  /* propagate at-most-one groups natively, their binary clauses left out of _clause_db */
+  _amo_lits.clear();
+  _amo_start.assign(1, 0);
+  _amo_occ.clear();
+  if(groups == NULL || groups->empty())
+    return;
+  _amo_occ.resize(2*_max_var_idx + 2);
+  for(vector<vector<int> >::const_iterator git=groups->begin(); git!=groups->end(); ++git){
+    for(vector<int>::const_iterator lit=git->begin(); lit!=git->end(); ++lit){
+      _amo_occ[_lit_idx(*lit)].push_back(_amo_start.size() - 1);
+      _amo_lits.push_back(*lit);
+    }
+    _amo_start.push_back(_amo_lits.size());
+  }
+  _init(); // scores count the groups
+}
+
+void sat::set_chrono(int threshold){
+  /* backjumps longer than threshold levels only undo the current level, 0 turns it off */
+  _chrono = threshold;
+}
+
+void sat::set_branch(int kind){
+  /* BRANCH_SWITCH decides by vmtf until restarts are STABLE_RESTART_INTERVAL apart, then by lrb */
+  if(_phase_decider[1] != _phase_decider[0])
+    delete _phase_decider[1];
+  delete _phase_decider[0];
+  if(kind == BRANCH_SWITCH){
+    _phase_decider[0] = new_decider(BRANCH_VMTF, _value);
+    _phase_decider[1] = new_decider(BRANCH_LRB, _value);
+  }
+  else
+    _phase_decider[0] = _phase_decider[1] = new_decider(kind, _value);
+  _decider = _phase_decider[_n_conflict_to_restart >= STABLE_RESTART_INTERVAL];
+  _init_to_assign_with_var_info();
+}
+
+void sat::set_saved_phase(const vector<int> &phase){
+  /* branch on phase instead of a random polarity, then keep saving phases */
+  _saved_phase = phase;
+  _saved_phase.resize(_max_var_idx + 1, UNASSIGNED);
+}
+
+void sat::set_warm_start(const checkpoint &state){
+  /* the phase of an earlier run, its activity order blended into the weights */
+  set_saved_phase(state.phase);
+  _warm_rank = state.rank;
+  _init();
 }
 
-void sat::get_learnt_clause(vector<vector<int> > &fill_learnt_clause){
-  for(int c=_transfered_db_size; c<_clause_db.size(); ++c)
+void sat::get_best_phase(vector<int> &fill_phase, int &fill_trail){
+  fill_phase = _best_phase;
+  fill_trail = _best_trail;
+}
+
+void sat::get_stats(long &n_conflict, long &n_decision, long &n_assign){
+  n_conflict = _n_conflicts;
+  n_decision = _n_decisions;
+  n_assign = _n_assigns;
+}
+
+bool sat::get_model(vector<int> &fill_model){
+  /* the assignment by var, false if it does not satisfy the formula */
+  fill_model = _value;
+  return _verify();
+}
+
+void sat::get_activity(vector<double> &fill_activity){
+  fill_activity.assign(_max_var_idx + 1, 0);
+  for(int v=1; v<=_max_var_idx; ++v)
+    fill_activity[v] = _decider->activity(v);
+}
+
+void sat::get_learnt_clause(vector<vector<int> > &fill_learnt_clause, vector<int> &fill_lbd){
+  for(int c=_transfered_db_size; c<_clause_db.size(); ++c){
     fill_learnt_clause.push_back(_clause_db.at(c));
+    fill_lbd.push_back(_clause_lbd.at(c));
+  }
 }
 
-bool sat::solve(){
+int sat::solve(bool *time_to_ret, pthread_mutex_t *stop_mutex){
+  /* SAT, UNSAT, or NOT_YET once *time_to_ret is set, read under stop_mutex if given */
   if(!_preproc())
-    return false;
+    return UNSAT;
 
   int n_conflict = 0;
   while(true){
@@ -51,17 +190,17 @@ bool sat::solve(){
       n_conflict = 0;
       --_restart_chance;
       if(!_preproc())
-        return false;
+        return UNSAT;
     }
     vector<int> to_bcp_clause;
     to_bcp_clause.clear();
     int conflicting_clause, conflicting_var;
     if(!_branch_get_bcp_clause(to_bcp_clause)) // false means no unassigned var
-      return true;
+      return SAT;
 
     while(!_bcp(to_bcp_clause, conflicting_clause, conflicting_var)){
       if(_cur_level == 0 && !_has_decision())
-          return false;
+          return UNSAT;
       ++n_conflict;
       to_bcp_clause.clear();
       bool learnt = false;
@@ -71,13 +210,20 @@ bool sat::solve(){
       if(learnt){
         int check_status = _check_learnt_clause(learnt_clause);
         if(check_status == NULL_CLAUSE)
-          return false;
+          return UNSAT;
         if(check_status == COULD_ADD){
           _add_learnt_clause(learnt_clause);
           _has_add_clause = true;
           to_bcp_clause.push_back(_clause_db.size()-1);
         }
       }
+      if(stop_mutex != NULL)
+        pthread_mutex_lock(stop_mutex);
+      bool stop = *time_to_ret;
+      if(stop_mutex != NULL)
+        pthread_mutex_unlock(stop_mutex);
+      if(stop)
+        return NOT_YET;
     }
   }
 }
@@ -131,37 +277,207 @@ int sat::thread_learn(int n_conflict_to_return, bool *time_to_ret){
   }
 }
 
-void sat::write_result_file(char *filename){
+int sat::solve_cube(vector<int> &cube, int n_conflict_budget, bool *time_to_ret){
+  /* like thread_learn with the cube literals decided first; UNSAT means the cube is refuted */
+  _assumptions = cube;
+  _restart();
+  _simulated_annealing();
+  _assump_level = 0;
+  if(!_preproc())
+    return UNSAT;
+
+  int n_conflict = 0;
+  while(true){
+    vector<int> to_bcp_clause;
+    int conflicting_clause, conflicting_var;
+    int assump_status = _decide_assumption(to_bcp_clause);
+    if(assump_status == CONFLICT)
+      return UNSAT;
+    if(assump_status == ALREADY_ASSIGNED_SAME && !_branch_get_bcp_clause(to_bcp_clause))
+      return SAT;
+
+    while(!_bcp(to_bcp_clause, conflicting_clause, conflicting_var)){
+      if(_cur_level <= _assump_level) // nothing but assumptions decided
+        return UNSAT;
+      ++n_conflict;
+      to_bcp_clause.clear();
+      bool learnt = false;
+      vector<int> learnt_clause;
+      int back_level = _analyze_conflict(conflicting_clause, conflicting_var, learnt, learnt_clause);
+      _backtrack(back_level, to_bcp_clause);
+      if(_assump_level > back_level)
+        _assump_level = back_level;
+      if(learnt){
+        int check_status = _check_learnt_clause(learnt_clause);
+        if(check_status == NULL_CLAUSE)
+          return UNSAT;
+        if(check_status == COULD_ADD){
+          _add_learnt_clause(learnt_clause);
+          _has_add_clause = true;
+          to_bcp_clause.push_back(_clause_db.size()-1);
+        }
+      }
+      if(*time_to_ret)
+        return NOT_YET;
+    }
+    if(n_conflict >= n_conflict_budget)
+      return NOT_YET;
+  }
+}
+
+long sat::enumerate(const vector<int> &project, long max_models, ostream &out){
+  /* write models to out as found, up to max_models (0 for all). each model
+   * gets blocked and the search goes on with its learnt clauses and scores:
+   * by the negation of its decisions, or of the project lits when given */
+  _enumerating = true;
+  long n_model = 0;
+  if(!_preproc())
+    return n_model;
+
+  int n_conflict = 0;
+  while(true){
+    if(n_conflict >= _n_conflict_to_restart && _restart_chance > 0){
+      _restart();
+      _simulated_annealing();
+      n_conflict = 0;
+      --_restart_chance;
+      if(!_preproc())
+        return n_model;
+    }
+    vector<int> to_bcp_clause;
+    int conflicting_clause, conflicting_var;
+    if(!_branch_get_bcp_clause(to_bcp_clause)){ // a model
+      assert(_verify());
+      _write_model(project, out);
+      if(++n_model == max_models || !_block_model(project, to_bcp_clause))
+        return n_model;
+    }
+
+    while(!_bcp(to_bcp_clause, conflicting_clause, conflicting_var)){
+      if(_cur_level == 0 && !_has_decision())
+          return n_model;
+      ++n_conflict;
+      to_bcp_clause.clear();
+      bool learnt = false;
+      vector<int> learnt_clause;
+      int back_level = _analyze_conflict(conflicting_clause, conflicting_var, learnt, learnt_clause);
+      _backtrack(back_level, to_bcp_clause);
+      if(learnt){
+        int check_status = _check_learnt_clause(learnt_clause);
+        if(check_status == NULL_CLAUSE)
+          return n_model;
+        if(check_status == COULD_ADD){
+          _add_learnt_clause(learnt_clause);
+          _has_add_clause = true;
+          to_bcp_clause.push_back(_clause_db.size()-1);
+        }
+      }
+    }
+  }
+}
+
+bool sat::_block_model(const vector<int> &project, vector<int> &fill_bcp_clause){
+  /* add the blocking clause and backtrack below its highest level, where it
+   * propagates or waits on its watches; false if it is falsified at level 0.
+   * decisions suffice without projection: they propagate the rest */
+  vector<bool> in_project(_max_var_idx + 1, project.empty());
+  for(vector<int>::const_iterator vit=project.begin(); vit!=project.end(); ++vit)
+    in_project.at(*vit) = true;
+  vector<int> clause;
+  int top_level = 0;
+  for(deque<assignment>::iterator ait=_assign_deque.begin(); ait!=_assign_deque.end(); ++ait){
+    if(!in_project.at(abs(ait->value)) || (project.empty() && (ait->antec != NO_ANTEC || ait->level == 0)))
+      continue;
+    clause.push_back(-ait->value);
+    top_level = max(top_level, ait->level);
+  }
+  if(top_level == 0)
+    return false;
+  _backtrack(top_level - 1, fill_bcp_clause);
+  _add_learnt_clause(clause);
+  fill_bcp_clause.push_back(_clause_db.size()-1);
+  return true;
+}
+
+void sat::_write_model(const vector<int> &project, ostream &out){
+  out << 'v';
+  if(project.empty())
+    for(int v=1; v<=_max_var_idx; ++v)
+      out << ' ' << _value.at(v);
+  else
+    for(vector<int>::const_iterator vit=project.begin(); vit!=project.end(); ++vit)
+      out << ' ' << _value.at(*vit);
+  out << " 0" << endl;
+}
+
+int sat::pick_split_var(vector<int> &cube){
+  /* most active var not fixed by the cube, 0 if there is none */
+  vector<bool> in_cube(_max_var_idx + 1, false);
+  for(vector<int>::iterator lit=cube.begin(); lit!=cube.end(); ++lit)
+    in_cube.at(abs(*lit)) = true;
+  int best_var = 0;
+  for(int v=1; v<=_max_var_idx; ++v){
+    if(in_cube.at(v) || (_value.at(v) != UNASSIGNED && _level.at(v) <= _assump_level))
+      continue;
+    if(best_var == 0 || _decider->activity(v) > _decider->activity(best_var))
+      best_var = v;
+  }
+  return best_var;
+}
+
+void sat::import_clause(vector<int> &clause){
+  /* takes effect on the next restart; the exporter already logged it */
+  _clause_db.push_back(clause);
+  _clause_lbd.push_back(clause.size());
+  _clause_bytes += mem_governor::clause_bytes(_clause_db.back());
+}
+
+void sat::get_short_learnt(vector<vector<int> > &fill_learnt){
+  fill_learnt.swap(_short_learnt);
+  _short_learnt.clear();
+}
+
+void sat::flush_proof(){
+  if(_proof != NULL)
+    _proof->flush();
+}
+
+void sat::write_result_file(char *filename, int n_out_var){
   bool solved = _verify();
   int len = strlen(filename);
   filename[len-3] = 's'; filename[len-2] = 'a'; filename[len-1] = 't';
   ofstream fout(filename);
   if(solved){
       fout << "s SATISFIABLE\nv ";
-      for(vector<var_info>::iterator vi = _var_info_vec.begin(); vi != _var_info_vec.end(); ++vi)
-          fout << vi->value << ' ';
+      for(int v=0; v<=n_out_var; ++v)
+          fout << _value.at(v) << ' ';
       fout << "0\n";
       cout << "SAT\n";
   }
   else{
       fout << "s UNSATISFIABLE\n";
       cout << "UNSAT\n";
+      if(_proof != NULL){
+        _proof->add(vector<int>());
+        _proof->flush();
+      }
   }
   fout.close();
 }
 
 bool sat::_verify(){
   for(int i=0; i<_ori_db_size; ++i){
-    bool clause_check = false;
-    for(vector<int>::iterator lit = _clause_db.at(i).begin(); lit != _clause_db.at(i).end(); ++lit){
-        if(_var_info_vec.at(abs(*lit)).value == *lit){
-            clause_check = true;
-            break;
-        }
-    }
-    if(!clause_check)
+    vector<int> &clause = _clause_db.at(i);
+    if(clause.empty() || !simd_any_true(&clause[0], clause.size(), &_lit_value[0]))
         return false;
   }
+  for(unsigned g=0; g+1<_amo_start.size(); ++g){
+    int n_true = 0;
+    for(int i=_amo_start[g]; i<_amo_start[g+1]; ++i)
+      n_true += _lit_value[_lit_idx(_amo_lits[i])] == LIT_TRUE;
+    if(n_true > 1)
+      return false;
+  }
   return true;
 }
 
@@ -170,24 +486,79 @@ void sat::_init(){
   _init_var_info();
   _init_to_assign_with_var_info();
   _assign_deque.clear();
+  _bin_queue.clear();
+  _bin_head = 0;
   _cur_level = 0;
   _has_add_clause = false;
+  if(_gauss != NULL)
+    _gauss->reset();
+  _xor_reason.clear();
 }
 
 void sat::_init_var_info(){
-  /* clear and init var_info_vec */
-  _var_info_vec.clear();
-  _var_info_vec.resize(_max_var_idx + 1); // [0] not used
+  /* clear and init the variable arrays and occurrence lists */
+  int n_var = _max_var_idx + 1; // [0] not used
+  _value.assign(n_var, UNASSIGNED);
+  _level.assign(n_var, 0);
+  _antec.assign(n_var, NO_ANTEC);
+  _order.assign(n_var, 0);
+  _seen.assign(n_var, 0);
+  _lit_mark.assign(n_var, 0);
+  _score.assign(n_var, 0);
+  _lit_value.assign(2*_max_var_idx + 2 + SIMD_VALUE_PAD, LIT_FREE);
+  _bin_watch.clear();
+  _bin_watch.resize(2*_max_var_idx + 2);
+  _occ_start.assign(2*_max_var_idx + 3, 0);
   for(unsigned c=0; c<_clause_db.size(); ++c){
+    bool is_bin = _clause_db.at(c).size() == 2;
+    if(is_bin)
+      _add_bin_watch(c);
     for(vector<int>::iterator lit=_clause_db.at(c).begin(); lit!=_clause_db.at(c).end(); ++lit){
-      int lit_idx = abs(*lit);
-      if(*lit > 0)
-        _var_info_vec.at(lit_idx).pos_vec.push_back(c);
-      else
-        _var_info_vec.at(lit_idx).neg_vec.push_back(c);
-      _var_info_vec.at(lit_idx).score += 2;
+      if(!is_bin) // binary clauses only live in _bin_watch
+        ++_occ_start[_lit_idx(*lit) + 1];
+      _score.at(abs(*lit)) += 2;
     }
   }
+  for(unsigned l=1; l<_occ_start.size(); ++l)
+    _occ_start[l] += _occ_start[l-1];
+  _occ.resize(_occ_start.back());
+  vector<int> fill(_occ_start.begin(), _occ_start.end() - 1);
+  for(unsigned c=0; c<_clause_db.size(); ++c)
+    if(_clause_db.at(c).size() != 2)
+      for(vector<int>::iterator lit=_clause_db.at(c).begin(); lit!=_clause_db.at(c).end(); ++lit)
+        _occ[fill[_lit_idx(*lit)]++] = c;
+  _occ_extra.clear();
+  _occ_extra.resize(2*_max_var_idx + 2);
+  for(unsigned g=0; g+1<_amo_start.size(); ++g) // as much as the pairwise clauses
+    for(int i=_amo_start[g]; i<_amo_start[g+1]; ++i)
+      _score.at(abs(_amo_lits[i])) += 2*(_amo_start[g+1] - _amo_start[g] - 1);
+  if(!_warm_rank.empty()){
+    /* ranks scaled to the heaviest weight, both orders count alike */
+    int max_score = *max_element(_score.begin(), _score.end());
+    for(int v=1; v<=_max_var_idx; ++v)
+      _score[v] += int(double(_warm_rank[v]) * max_score / _max_var_idx);
+  }
+}
+
+void sat::_append_occ(int lit, vector<int> &fill_clause){
+  /* the clauses of more than two literals holding lit */
+  int lit_idx = _lit_idx(lit);
+  fill_clause.insert(fill_clause.end(), _occ.begin() + _occ_start[lit_idx], _occ.begin() + _occ_start[lit_idx+1]);
+  fill_clause.insert(fill_clause.end(), _occ_extra[lit_idx].begin(), _occ_extra[lit_idx].end());
+}
+
+int sat::_n_occ(int lit){
+  int lit_idx = _lit_idx(lit);
+  return _occ_start[lit_idx+1] - _occ_start[lit_idx] + _occ_extra[lit_idx].size();
+}
+
+void sat::_add_bin_watch(int clause_idx){
+  int lit1 = _clause_db.at(clause_idx).at(0);
+  int lit2 = _clause_db.at(clause_idx).at(1);
+  vector<int> &watch1 = _bin_watch.at(_lit_idx(-lit1));
+  watch1.push_back(lit2); watch1.push_back(clause_idx);
+  vector<int> &watch2 = _bin_watch.at(_lit_idx(-lit2));
+  watch2.push_back(lit1); watch2.push_back(clause_idx);
 }
 
 void sat::_init_watch(){
@@ -208,14 +579,13 @@ void sat::_init_watch(){
 }
 
 void sat::_init_to_assign_with_var_info(){
-  /* clear and init to_assign_heap, to_assign_vec */
-  _to_assign_heap.clear();
+  /* clear and init the deciders, to_assign_vec */
+  _phase_decider[0]->reset(_score);
+  if(_phase_decider[1] != _phase_decider[0])
+    _phase_decider[1]->reset(_score);
   _to_assign_vec.clear();
-  for(int v=1; v<=_max_var_idx; ++v){
-    _to_assign_heap.push_back(var_score(v, &_var_info_vec.at(v).score));
+  for(int v=1; v<=_max_var_idx; ++v)
     _to_assign_vec.push_back(v);
-  }
-  make_heap(_to_assign_heap.begin(), _to_assign_heap.end(), _score_cmp);
 }
 
 void sat::_simulated_annealing(){
@@ -234,6 +604,8 @@ void sat::_simulated_annealing(){
     if(_n_conflict_to_restart_bound < N_CONFLICT_TO_RESTART_HARD_LIMIT)
       _n_conflict_to_restart_bound *= 2;
   }
+  _decider = _phase_decider[_n_conflict_to_restart >= STABLE_RESTART_INTERVAL];
+  trace_instant("anneal", _n_conflict_to_restart);
 }
 
 bool sat::_assign_handler(int var, int level, int antec, vector<int> &fill_bcp_clause){
@@ -242,10 +614,10 @@ bool sat::_assign_handler(int var, int level, int antec, vector<int> &fill_bcp_c
   if(assign_status == CONFLICT)
     return false;
   else if(assign_status == SUCCESSFULLY_ASSIGNED){
-    vector<int>* to_check = var>0? &_var_info_vec.at(abs(var)).neg_vec: &_var_info_vec.at(abs(var)).pos_vec;
-    _update_watch(*to_check);
-    for(vector<int>::iterator it=to_check->begin(); it!=to_check->end(); ++it)
-      fill_bcp_clause.push_back(*it);
+    _bin_queue.push_back(var);
+    unsigned from = fill_bcp_clause.size();
+    _append_occ(-var, fill_bcp_clause);
+    _update_watch(fill_bcp_clause, from);
     return true;
   }
   else
@@ -254,11 +626,10 @@ bool sat::_assign_handler(int var, int level, int antec, vector<int> &fill_bcp_c
 
 int sat::_try_assign(int var, int level, int antec){
   /* check if no conflict then assign, else return false */
-  int var_value = _var_info_vec.at(abs(var)).value;
-  assert(var_value == var || var_value == UNASSIGNED || var_value == -var);
-  if(var_value == var)
+  int lit_value = _lit_value[_lit_idx(var)];
+  if(lit_value == LIT_TRUE)
     return ALREADY_ASSIGNED_SAME;
-  else if(var_value == UNASSIGNED){
+  else if(lit_value == LIT_FREE){
     _assign(var, level, antec);
     return SUCCESSFULLY_ASSIGNED;
   }
@@ -267,18 +638,26 @@ int sat::_try_assign(int var, int level, int antec){
 }
 
 void sat::_assign(int var, int level, int antec){
+  ++_n_assigns;
   if(level == 0)
     _assign_deque.push_front(assignment(var, 0, antec));
   else
     _assign_deque.push_back(assignment(var, level, antec));
   int var_idx = abs(var);
-  _var_info_vec.at(var_idx).value = var;
-  _var_info_vec.at(var_idx).level = level;
-  _var_info_vec.at(var_idx).antec = antec;
-  _var_info_vec.at(var_idx).order = _assign_deque.size();
+  _value[var_idx] = var;
+  _lit_value[_lit_idx(var)] = LIT_TRUE;
+  _lit_value[_lit_idx(-var)] = LIT_FALSE;
+  _level[var_idx] = level;
+  _antec[var_idx] = antec;
+  _order[var_idx] = _assign_deque.size();
+  _decider->assigned(var_idx);
+  if(_gauss != NULL)
+    _gauss->assign(var_idx, var > 0);
 }
 
 bool sat::_preproc(){
+  if(_gauss != NULL && !_gauss->consistent())
+    return false;
   vector<int> len_1_clause, one_phase_var, to_bcp_clause;
   _fill_len_1_clause(len_1_clause);
   for(vector<int>::iterator it=len_1_clause.begin(); it!=len_1_clause.end(); ++it){
@@ -286,7 +665,8 @@ bool sat::_preproc(){
     if(!_assign_handler(var, 0, *it, to_bcp_clause))
       return false;
   }
-  _fill_1_phase_var(one_phase_var);
+  if(_assumptions.empty() && !_enumerating) // a pure literal may contradict a cube, or drop models
+    _fill_1_phase_var(one_phase_var);
   for(vector<int>::iterator it=one_phase_var.begin(); it!=one_phase_var.end(); ++it){
     if(!_assign_handler(*it, 0, NO_ANTEC, to_bcp_clause))
       return false;
@@ -305,13 +685,29 @@ void sat::_fill_len_1_clause(vector<int> &len_1_clause){
 
 void sat::_fill_1_phase_var(vector<int> &one_phase_var){
   for(int v=1; v<=_max_var_idx; ++v)
-    if(_var_info_vec.at(v).neg_vec.size() == 0)
+    if(_n_occ(-v) == 0 && _bin_watch.at(_lit_idx(v)).empty() && (_amo_occ.empty() || _amo_occ[_lit_idx(v)].empty()))
       one_phase_var.push_back(v);
-    else if(_var_info_vec.at(v).pos_vec.size() == 0)
+    else if(_n_occ(v) == 0 && _bin_watch.at(_lit_idx(-v)).empty() && (_amo_occ.empty() || _amo_occ[_lit_idx(-v)].empty()))
       one_phase_var.push_back(-v);
     else;
 }
 
+int sat::_decide_assumption(vector<int> &fill_bcp_clause){
+  /* decide the first open assumption; CONFLICT if one is already false */
+  for(vector<int>::iterator lit=_assumptions.begin(); lit!=_assumptions.end(); ++lit){
+    int value = _lit_value[_lit_idx(*lit)];
+    if(value == LIT_TRUE)
+      continue;
+    if(value == LIT_FALSE)
+      return CONFLICT;
+    _assump_level = ++_cur_level;
+    ++_n_decisions;
+    _assign_handler(*lit, _cur_level, NO_ANTEC, fill_bcp_clause);
+    return SUCCESSFULLY_ASSIGNED;
+  }
+  return ALREADY_ASSIGNED_SAME;
+}
+
 bool sat::_branch_get_bcp_clause(vector<int> &fill_bcp_clause){
   int to_assign_var;
   if(rand_r(&_seed) % _denominator < _numerator){ // random branch
@@ -321,65 +717,127 @@ bool sat::_branch_get_bcp_clause(vector<int> &fill_bcp_clause){
       int random_idx = rand_r(&_seed) % (_to_assign_vec.size());
       to_assign_var = _to_assign_vec.at(random_idx);
       _to_assign_vec.at(random_idx) = _to_assign_vec.back(); _to_assign_vec.pop_back();
-      if(_var_info_vec.at(to_assign_var).value == UNASSIGNED)
+      if(_value.at(to_assign_var) == UNASSIGNED)
         break;
     }
   }
   else{ // heuristic branch
-    while(true){
-      if(_to_assign_heap.empty())
-        return false;
-      to_assign_var = _to_assign_heap.front().var;
-      pop_heap(_to_assign_heap.begin(), _to_assign_heap.end(), _score_cmp); _to_assign_heap.pop_back();
-      if(_var_info_vec.at(to_assign_var).value == UNASSIGNED)
-        break;
-    }
+    to_assign_var = _decider->next();
+    if(to_assign_var == 0)
+      return false;
   }
-  if(rand_r(&_seed) % 2)
+  if(!_saved_phase.empty() && _saved_phase.at(to_assign_var) != UNASSIGNED)
+    to_assign_var = _saved_phase.at(to_assign_var);
+  else if(rand_r(&_seed) % 2)
     to_assign_var *= -1;
+  ++_n_decisions;
   assert(_assign_handler(to_assign_var, ++_cur_level, NO_ANTEC, fill_bcp_clause) == true);
   return true;
 }
 
-void sat::_update_watch(vector<int> &clause_to_update){
-  for(vector<int>::iterator it=clause_to_update.begin(); it!=clause_to_update.end(); ++it){
+void sat::_update_watch(vector<int> &clause_to_update, unsigned from){
+  for(vector<int>::iterator it=clause_to_update.begin()+from; it!=clause_to_update.end(); ++it){
     if(_clause_db.at(*it).size() <= 2)
       continue;
     twoidx *watch = &_watch_db.at(*it);
     int var1 = _clause_db.at(*it).at(watch->idx1);
     int var2 = _clause_db.at(*it).at(watch->idx2);
     bool successfully_moved = true;
-    if(var1 == -_var_info_vec.at(abs(var1)).value){
+    if(_lit_value[_lit_idx(var1)] == LIT_FALSE){
       successfully_moved = _try_move_watch(&watch->idx1, &watch->idx2, _clause_db.at(*it));
     }
-    if(var2 == -_var_info_vec.at(abs(var2)).value && successfully_moved){
+    if(_lit_value[_lit_idx(var2)] == LIT_FALSE && successfully_moved){
       _try_move_watch(&watch->idx2, &watch->idx1, _clause_db.at(*it));
     }
   }
 }
 
 bool sat::_try_move_watch(int *to_move, int *another, vector<int> &clause){
+  /* first literal not false after a random spot, wrapping around, other
+   * than the other watch; the random spot itself is the last resort */
   int clause_size = clause.size();
   int ori_rand_loc = rand_r(&_seed) % clause_size;
-  int rand_loc = (ori_rand_loc + 1) % clause_size;
-  int var;
-  while(true){
-    var = clause.at(rand_loc);
-    if(_var_info_vec.at(abs(var)).value != -var && rand_loc != *another || rand_loc == ori_rand_loc)
+  const int *lits = &clause[0];
+  const signed char *value = &_lit_value[0];
+  int found = ori_rand_loc;
+  for(int from=ori_rand_loc+1, to=clause_size, pass=0; pass<2; from=0, to=ori_rand_loc, ++pass){
+    while(from < to){
+      int loc = from + simd_first_non_false(lits + from, to - from, value);
+      if(loc != *another || loc >= to){
+        from = loc;
+        break;
+      }
+      from = loc + 1;
+    }
+    if(from < to){
+      found = from;
       break;
-    else
-      rand_loc = (rand_loc + 1) % clause_size;
+    }
   }
-  *to_move = rand_loc;
-  if(_var_info_vec.at(abs(var)).value != -var)
-    return true;
-  else
-    return false;
+  *to_move = found;
+  return value[_lit_idx(lits[found])] != LIT_FALSE;
+}
+
+bool sat::_bin_bcp(vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
+  /* propagate every queued literal over its implicit binary watches */
+  while(_bin_head < _bin_queue.size()){
+    int var = _bin_queue[_bin_head++];
+    vector<int> &implied = _bin_watch[_lit_idx(var)];
+    int n = implied.size();
+    const int *pair = n == 0 ? NULL : &implied[0];
+    for(int i=0; i<n; i+=2){
+      int to_assign_var = pair[i];
+      int value = _lit_value[_lit_idx(to_assign_var)];
+      if(value == LIT_TRUE)
+        continue;
+      if(value == LIT_FREE){
+        _assign_handler(to_assign_var, _implied_level(pair[i+1], to_assign_var), pair[i+1], to_bcp_clause);
+        continue;
+      }
+      fill_c_clause = pair[i+1];
+      fill_c_var = to_assign_var;
+      return false;
+    }
+    if(!_amo_occ.empty() && !_amo_bcp(var, to_bcp_clause, fill_c_clause, fill_c_var))
+      return false;
+  }
+  return true;
+}
+
+bool sat::_amo_bcp(int var, vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
+  /* var became true: every other lit of its groups goes false */
+  int antec = AMO_ANTEC(_lit_idx(var));
+  vector<int> &groups = _amo_occ[_lit_idx(var)];
+  for(vector<int>::iterator g=groups.begin(); g!=groups.end(); ++g)
+    for(int i=_amo_start[*g]; i<_amo_start[*g+1]; ++i){
+      int to_assign_var = -_amo_lits[i];
+      int value = _lit_value[_lit_idx(to_assign_var)];
+      if(value == LIT_TRUE || to_assign_var == -var)
+        continue;
+      if(value == LIT_FREE){
+        _assign_handler(to_assign_var, _implied_level(antec, to_assign_var), antec, to_bcp_clause);
+        continue;
+      }
+      fill_c_clause = antec;
+      fill_c_var = to_assign_var;
+      return false;
+    }
+  return true;
 }
 
 bool sat::_bcp(vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
-  /* if conflict, fill c_clause and c_var */
-  for(int i=0; i<to_bcp_clause.size(); ++i){
+  /* if conflict, fill c_clause and c_var; binary implications go first */
+  for(int i=0; ; ++i){
+    if(!_bin_bcp(to_bcp_clause, fill_c_clause, fill_c_var))
+      return false;
+    if(i >= to_bcp_clause.size()){
+      if(_gauss == NULL || !_gauss->has_work())
+        break;
+      if(!_xor_bcp(to_bcp_clause, fill_c_clause, fill_c_var))
+        return false;
+      --i; // the clauses the xor implications woke up
+      continue;
+    }
     int clause_idx = to_bcp_clause.at(i);
     bool got_unit = false;
     int to_assign_var = 0;
@@ -390,18 +848,18 @@ bool sat::_bcp(vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
     else{
       int var1 = _clause_db.at(clause_idx).at(_watch_db.at(clause_idx).idx1);
       int var2 = _clause_db.at(clause_idx).at(_watch_db.at(clause_idx).idx2);
-      if(_var_info_vec.at(abs(var1)).value == -var1){
+      if(_lit_value[_lit_idx(var1)] == LIT_FALSE){
         got_unit = true;
         to_assign_var = var2;
       }
-      else if(_var_info_vec.at(abs(var2)).value == -var2){
+      else if(_lit_value[_lit_idx(var2)] == LIT_FALSE){
         got_unit = true;
         to_assign_var = var1;
       }
       else;
     }
     if(got_unit){
-      if(!_assign_handler(to_assign_var, _cur_level, clause_idx, to_bcp_clause)){
+      if(!_assign_handler(to_assign_var, _implied_level(clause_idx, to_assign_var), clause_idx, to_bcp_clause)){
         fill_c_clause = clause_idx;
         fill_c_var = to_assign_var;
         return false;
@@ -411,6 +869,63 @@ bool sat::_bcp(vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
   return true;
 }
 
+bool sat::_xor_bcp(vector<int> &to_bcp_clause, int &fill_c_clause, int &fill_c_var){
+  /* assign what the xor rows imply, their row clauses as lazy reasons */
+  vector<int> implied, conflict;
+  vector<vector<int> > reason;
+  bool consistent = _gauss->propagate(implied, reason, conflict);
+  for(unsigned j=0; j<implied.size(); ++j){
+    int antec = XOR_ANTEC(int(_xor_reason.size()));
+    _xor_reason.push_back(vector<int>());
+    _xor_reason.back().swap(reason.at(j));
+    if(!_assign_handler(implied.at(j), _implied_level(antec, implied.at(j)), antec, to_bcp_clause)){
+      fill_c_clause = antec;
+      fill_c_var = implied.at(j);
+      return false;
+    }
+  }
+  if(consistent)
+    return true;
+  /* every literal is false, blame the latest at this level */
+  int latest_order = -1;
+  fill_c_var = conflict.at(0);
+  for(vector<int>::iterator lit=conflict.begin(); lit!=conflict.end(); ++lit){
+    int var_idx = abs(*lit);
+    if(_level[var_idx] == _cur_level && _order[var_idx] > latest_order){
+      latest_order = _order[var_idx];
+      fill_c_var = *lit;
+    }
+  }
+  fill_c_clause = XOR_ANTEC(int(_xor_reason.size()));
+  _xor_reason.push_back(conflict);
+  return false;
+}
+
+int sat::_implied_level(int antec, int lit){
+  /* the current level, or with chronological backtracking the highest
+   * level in the reason, which may be below the current one */
+  if(_chrono == 0)
+    return _cur_level;
+  int level = 0;
+  vector<int> &reason = _reason_clause(antec, lit);
+  for(vector<int>::iterator rit=reason.begin(); rit!=reason.end(); ++rit)
+    if(*rit != lit)
+      level = max(level, _level[abs(*rit)]);
+  return level;
+}
+
+vector<int> &sat::_reason_clause(int antec, int lit){
+  /* the clause behind antec, lit being its literal on the var it explains */
+  if(antec >= 0)
+    return _clause_db.at(antec);
+  if(!IS_AMO_ANTEC(antec))
+    return _xor_reason.at(XOR_REASON(antec));
+  int true_idx = AMO_LIT_IDX(antec);
+  _amo_reason.assign(2, lit);
+  _amo_reason[1] = true_idx & 1 ? true_idx >> 1 : -(true_idx >> 1);
+  return _amo_reason;
+}
+
 bool sat::_has_decision(){
   for(deque<assignment>::iterator vit=_assign_deque.begin(); vit!=_assign_deque.end(); ++vit)
     if(vit->antec == NO_ANTEC)
@@ -419,73 +934,86 @@ bool sat::_has_decision(){
 }
 
 int sat::_analyze_conflict(int c_clause_idx, int c_var, bool &learnt, vector<int> &fill_learnt_clause){
-  vector<int> clause = _clause_db.at(c_clause_idx);
-  _var_info_vec.at(abs(c_var)).order = _assign_deque.size()+1;
-  _var_info_vec.at(abs(c_var)).level = _cur_level;
+  _save_best_trail();
+  ++_n_conflicts;
+  vector<int> clause = _reason_clause(c_clause_idx, c_var);
+  if(_chrono > 0)
+    _backtrack_to_conflict(clause);
+  /* c_var counts as the latest implication during the analysis only, it
+   * keeps its assignment and the level and order that go with it */
+  int saved_order = _order.at(abs(c_var)), saved_level = _level.at(abs(c_var));
+  _order.at(abs(c_var)) = _assign_deque.size()+1;
+  _level.at(abs(c_var)) = _cur_level;
   learnt = _try_find_1uip(clause);
+  _decider->conflict(_analyzed);
   if(learnt)
     fill_learnt_clause = clause;
-  return _find_back_level(clause);
+  int back_level = _find_back_level(clause);
+  _order.at(abs(c_var)) = saved_order;
+  _level.at(abs(c_var)) = saved_level;
+  if(_chrono > 0 && _cur_level - back_level > _chrono)
+    back_level = _cur_level - 1; // the asserting literal goes in out of order
+  return back_level;
 }
 
 bool sat::_try_find_1uip(vector<int> &clause){
+  /* also collects every var the clause holds along the way in _analyzed */
   bool find_something = false;
   int n_resolve = 0;
   int n_resolve_limit = _assign_deque.size();
+  _analyzed.clear();
   while(true){
+    for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit)
+      if(!_seen[abs(*vit)]){
+        _seen[abs(*vit)] = 1;
+        _analyzed.push_back(abs(*vit));
+      }
     int most_recent_order = 0;
     int most_recent_assigned_var_idx = 0;
-    int cur_level_implication_count = 0;
+    int cur_level_count = 0; // the decision counts too, it is not a uip next to an implication
     for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
       int var_idx = abs(*vit);
-      if(_var_info_vec.at(var_idx).level == _cur_level && _var_info_vec.at(var_idx).antec != NO_ANTEC){
-        int order = _var_info_vec.at(var_idx).order;
-        if(order > most_recent_order){
-          most_recent_order = order;
-          most_recent_assigned_var_idx = var_idx;
-        }
-        ++cur_level_implication_count;
+      if(_level.at(var_idx) != _cur_level)
+        continue;
+      ++cur_level_count;
+      if(_antec.at(var_idx) != NO_ANTEC && _order.at(var_idx) > most_recent_order){
+        most_recent_order = _order.at(var_idx);
+        most_recent_assigned_var_idx = var_idx;
       }
     }
-    if(cur_level_implication_count < 2)
+    if(cur_level_count < 2 || most_recent_assigned_var_idx == 0)
       break;
-    _resolve(clause, _var_info_vec.at(most_recent_assigned_var_idx).antec, most_recent_assigned_var_idx);
+    _resolve(clause, _antec.at(most_recent_assigned_var_idx), most_recent_assigned_var_idx);
     find_something = true;
     ++n_resolve;
     if(n_resolve >= n_resolve_limit)
       break;
   }
+  for(vector<int>::iterator vit=_analyzed.begin(); vit!=_analyzed.end(); ++vit)
+    _seen[*vit] = 0;
   return find_something;
 }
 
 void sat::_resolve(vector<int> &clause, int antec, int to_resolve_var_idx){
-  bool pos_has[_max_var_idx + 1] = {false};
-  bool neg_has[_max_var_idx + 1] = {false};
-  for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
-    if(*vit>0)
-      pos_has[*vit] = true;
-    else
-      neg_has[-*vit] = true;
-  }
-  for(vector<int>::iterator vit=_clause_db.at(antec).begin(); vit!=_clause_db.at(antec).end(); ++vit){
-    if(*vit>0)
-      pos_has[*vit] = true;
-    else
-      neg_has[-*vit] = true;
-  }
+  for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit)
+    _lit_mark[abs(*vit)] |= *vit>0 ? 1 : 2;
+  vector<int> &reason = _reason_clause(antec, _value.at(to_resolve_var_idx));
+  for(vector<int>::iterator vit=reason.begin(); vit!=reason.end(); ++vit)
+    _lit_mark[abs(*vit)] |= *vit>0 ? 1 : 2;
   clause.clear();
   for(int v=1; v<=_max_var_idx; ++v){
-    if(pos_has[v] && v != to_resolve_var_idx)
+    if((_lit_mark[v] & 1) && v != to_resolve_var_idx)
       clause.push_back(v);
-    if(neg_has[v] && v != to_resolve_var_idx)
+    if((_lit_mark[v] & 2) && v != to_resolve_var_idx)
       clause.push_back(-v);
+    _lit_mark[v] = 0;
   }
 }
 
 int sat::_find_back_level(vector<int> &clause){
   int back_level = 0;
   for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
-    int level = _var_info_vec.at(abs(*vit)).level;
+    int level = _level.at(abs(*vit));
     if(level < _cur_level && level > back_level)
       back_level = level;
   }
@@ -495,12 +1023,12 @@ int sat::_find_back_level(vector<int> &clause){
 int sat::_check_learnt_clause(vector<int> &clause){
   if(clause.size() == 0)
     return NULL_CLAUSE;
-  if(clause.size() > _learnt_size_limit){
+  if(clause.size() > _learnt_size_limit && !_enumerating){ // blocking clauses make long ones the rule
     // add clasue evaluation policy here
     int false_count = 0;
     bool already_true = false;
     for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
-      int var = _var_info_vec.at(abs(*vit)).value;
+      int var = _value.at(abs(*vit));
       if(var == *vit){
         already_true = true;
         break;
@@ -516,118 +1044,282 @@ int sat::_check_learnt_clause(vector<int> &clause){
     //  return COULD_ADD;
     return TOO_LARGE;
   }
-  bool pos_has[_max_var_idx + 1] = {false};
-  bool neg_has[_max_var_idx + 1] = {false};
-  for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
-    if(*vit>0){
-      if(neg_has[*vit])
-        return USELESS_CLAUSE;
-      pos_has[*vit] = true;
-    }
-    else{
-      if(pos_has[-*vit])
-        return USELESS_CLAUSE;
-      neg_has[-*vit] = true;
-    }
+  bool tautology = false;
+  for(vector<int>::iterator vit=clause.begin(); vit!=clause.end() && !tautology; ++vit){
+    char mark = *vit>0 ? 1 : 2;
+    tautology = _lit_mark[abs(*vit)] & (3 - mark);
+    _lit_mark[abs(*vit)] |= mark;
   }
-  return COULD_ADD;
+  for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit)
+    _lit_mark[abs(*vit)] = 0;
+  return tautology ? USELESS_CLAUSE : COULD_ADD;
 }
 
 void sat::_add_learnt_clause(vector<int> &clause){
-  _clause_db.push_back(clause);
-
+  /* glue: distinct levels among the assigned literals, the asserting one counts alone */
+  vector<int> levels;
   for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit){
-    if(*vit > 0)
-      _var_info_vec.at(*vit).pos_vec.push_back(_clause_db.size()-1);
-    else
-      _var_info_vec.at(-*vit).neg_vec.push_back(_clause_db.size()-1);
-    ++_var_info_vec.at(abs(*vit)).score;
+    int var_idx = abs(*vit);
+    levels.push_back(_value.at(var_idx) == UNASSIGNED ? -1 : _level.at(var_idx));
   }
+  sort(levels.begin(), levels.end());
+  _clause_lbd.push_back(unique(levels.begin(), levels.end()) - levels.begin());
+  _clause_db.push_back(clause);
+  _clause_bytes += mem_governor::clause_bytes(_clause_db.back());
+  if(_proof != NULL)
+    _proof->add(clause);
+  if(clause.size() <= 2)
+    _short_learnt.push_back(clause);
+
+  if(clause.size() == 2)
+    _add_bin_watch(_clause_db.size()-1);
+  else
+    for(vector<int>::iterator vit=clause.begin(); vit!=clause.end(); ++vit)
+      _occ_extra.at(_lit_idx(*vit)).push_back(_clause_db.size()-1);
+  _decider->learnt(clause);
 
   if(clause.size() == 1)
     _watch_db.push_back(twoidx(0, 0));
   else{
     _watch_db.push_back(twoidx(0, 1));
     vector<int> clause_to_update(1, _watch_db.size()-1);
-    _update_watch(clause_to_update);
+    _update_watch(clause_to_update, 0);
   }
 }
 
 void sat::_backtrack(int back_level, vector<int> &fill_bcp_clause){
-  for(int v=1; v<=_max_var_idx; ++v)
-    --_var_info_vec.at(v).score;
-
   //if(rand_r(&_seed) % (_denominator*_cur_level) < _numerator)
    // back_level = rand_r(&_seed) % _cur_level;
 
   vector<int> to_update_watch;
-  while(!_assign_deque.empty()){
-    assignment as = _assign_deque.back();
-    if(as.level > back_level || as.level == back_level && as.antec != NO_ANTEC || as.level == 0){
-      _assign_deque.pop_back();
-      int var_idx = abs(as.value);
-      _var_info_vec.at(var_idx).value = UNASSIGNED;
-      _to_assign_heap.push_back(var_score(var_idx, &_var_info_vec.at(var_idx).score));
-      _to_assign_vec.push_back(var_idx);
-
-      vector<int> *to_add_update;
-      if(as.value > 0)
-        to_add_update = &_var_info_vec.at(var_idx).neg_vec;
-      else
-        to_add_update = &_var_info_vec.at(var_idx).pos_vec;
-      for(vector<int>::iterator cit=to_add_update->begin(); cit!=to_add_update->end(); ++cit)
-        to_update_watch.push_back(*cit);
-    }
-    else 
-      break;
-  }
+  _bin_queue.clear();
+  _bin_head = 0;
+  unsigned n_kept = _pop_trail(back_level, false, to_update_watch);
   _cur_level = back_level;
-  _update_watch(to_update_watch);
+  _update_watch(to_update_watch, 0);
 
-  if(!_assign_deque.empty()){
-    assignment as = _assign_deque.back();
+  if(_assign_deque.size() > n_kept){
+    assignment as = _assign_deque.at(_assign_deque.size() - n_kept - 1);
     assert(as.antec == NO_ANTEC);
-    if(as.value > 0)
-      fill_bcp_clause = _var_info_vec.at(as.value).neg_vec;
-    else
-      fill_bcp_clause = _var_info_vec.at(-as.value).pos_vec;
+    _bin_queue.push_back(as.value);
+    fill_bcp_clause.clear();
+    _append_occ(-as.value, fill_bcp_clause);
   }
+  /* the conflict may have cut the propagation of the out of order ones short */
+  for(unsigned k=_assign_deque.size()-n_kept; k<_assign_deque.size(); ++k){
+    int value = _assign_deque[k].value;
+    _bin_queue.push_back(value);
+    _append_occ(-value, fill_bcp_clause);
+  }
+
+}
+
+void sat::_backtrack_to_conflict(vector<int> &clause){
+  /* out of order assignments can leave every literal of the conflict below
+   * the current level: undo the levels above it and analyze it there */
+  int conflict_level = 0;
+  for(vector<int>::iterator lit=clause.begin(); lit!=clause.end(); ++lit)
+    conflict_level = max(conflict_level, _level.at(abs(*lit)));
+  if(conflict_level >= _cur_level)
+    return;
+  vector<int> to_update_watch;
+  _pop_trail(conflict_level, true, to_update_watch);
+  _cur_level = conflict_level;
+  _update_watch(to_update_watch, 0);
+}
 
+unsigned sat::_pop_trail(int back_level, bool keep_implied, vector<int> &to_update_watch){
+  /* unassign down to the decision of back_level, its implications too unless
+   * keep_implied. assignments below back_level that chronological
+   * backtracking left above it go back on top in order, returns how many */
+  vector<assignment> kept;
+  while(!_assign_deque.empty()){
+    assignment as = _assign_deque.back();
+    bool pop = as.level > back_level || !keep_implied && (as.level == back_level && as.antec != NO_ANTEC || as.level == 0);
+    if(!pop && as.antec == NO_ANTEC)
+      break;
+    _assign_deque.pop_back();
+    if(!pop){
+      kept.push_back(as);
+      continue;
+    }
+    int var_idx = abs(as.value);
+    _value[var_idx] = UNASSIGNED;
+    _lit_value[2*var_idx] = _lit_value[2*var_idx+1] = LIT_FREE;
+    if(_gauss != NULL)
+      _gauss->unassign(var_idx);
+    if(!_saved_phase.empty())
+      _saved_phase.at(var_idx) = as.value;
+    _decider->unassigned(var_idx);
+    _to_assign_vec.push_back(var_idx);
+
+    _append_occ(-as.value, to_update_watch);
+  }
+  for(vector<assignment>::reverse_iterator ait=kept.rbegin(); ait!=kept.rend(); ++ait){
+    _assign_deque.push_back(*ait);
+    _order.at(abs(ait->value)) = _assign_deque.size();
+  }
+  if(_gauss != NULL){
+    /* drop the xor reasons no assignment left refers to */
+    int n_reason = 0;
+    for(deque<assignment>::iterator ait=_assign_deque.begin(); ait!=_assign_deque.end(); ++ait)
+      if(ait->antec < NO_ANTEC && !IS_AMO_ANTEC(ait->antec))
+        n_reason = max(n_reason, XOR_REASON(ait->antec) + 1);
+    _xor_reason.resize(n_reason);
+    _gauss->recheck_all();
+  }
+  return kept.size();
 }
 
 void sat::_restart(){
+  trace_instant("restart", _n_conflict_to_restart);
+  if(_governor != NULL){
+    if(_governor->pressure() >= MEM_HIGH)
+      _reduce_learnt();
+    _governor->report(_governor_slot, _clause_bytes);
+  }
   _init();
 }
 
+void sat::_reduce_learnt(){
+  /* keep learnt binaries and low glue clauses, only between _init calls.
+   * the deletions stay out of the proof: other threads may hold the same clause */
+  trace_begin("reduce");
+  int n_kept = _ori_db_size, n_transfered = _ori_db_size;
+  for(unsigned c=_ori_db_size; c<_clause_db.size(); ++c){
+    if(_clause_db.at(c).size() > 2 && _clause_lbd.at(c) > MEM_KEEP_LBD)
+      continue;
+    if(int(c) < _transfered_db_size)
+      ++n_transfered;
+    _clause_db.at(n_kept).swap(_clause_db.at(c));
+    _clause_lbd.at(n_kept) = _clause_lbd.at(c);
+    ++n_kept;
+  }
+  _clause_db.resize(n_kept);
+  _clause_lbd.resize(n_kept);
+  _transfered_db_size = n_transfered;
+  _clause_bytes = 0;
+  for(vector<vector<int> >::iterator cit=_clause_db.begin(); cit!=_clause_db.end(); ++cit)
+    _clause_bytes += mem_governor::clause_bytes(*cit);
+  trace_end("reduce");
+}
+
+void sat::_save_best_trail(){
+  if(int(_assign_deque.size()) <= _best_trail)
+    return;
+  _best_trail = _assign_deque.size();
+  _best_phase.assign(_max_var_idx + 1, UNASSIGNED);
+  for(int v=1; v<=_max_var_idx; ++v)
+    _best_phase.at(v) = _value.at(v);
+}
+
 void *mt_learn(void *arg_in){
-  mt_arg *arg = (mt_arg *)arg_in;
+  mt_thread_arg *thread_arg = static_cast<mt_thread_arg *>(arg_in);
+  mt_arg *arg = thread_arg->arg;
+  trace_lane("learn", thread_arg->idx);
+  trace_begin("round");
+  trace_begin("import"); // the solver copies the shared clause_db
 
-  sat sat_solver(*(arg->clause_db), arg->max_var_idx, arg->ori_db_size, time(NULL)+pthread_self(), arg->restart_chance, arg->numerator, arg->denominator);
+  const strategy &settings = thread_arg->settings;
+  trace_instant("arm", thread_arg->arm);
+
+  unsigned int seed = arg->deterministic ? thread_arg->seed : time(NULL)+pthread_self();
+  sat *sat_solver = new sat(*(arg->clause_db), arg->max_var_idx, arg->ori_db_size, seed, settings.restart_chance, settings.numerator, settings.denominator);
+  sat_solver->set_proof(arg->proof);
+  sat_solver->set_governor(arg->governor, thread_arg->idx);
+  sat_solver->set_gauss(arg->gauss);
+  sat_solver->set_amo(arg->amo);
+  if(arg->warm != NULL)
+    sat_solver->set_warm_start(*arg->warm);
+  sat_solver->set_chrono(arg->chrono);
+  sat_solver->set_branch(settings.branch);
+  if(arg->phases != NULL){
+    pthread_mutex_lock(&arg->phases->mutex);
+    if(arg->phases->sls_unsat >= 0)
+      sat_solver->set_saved_phase(arg->phases->sls_phase);
+    pthread_mutex_unlock(&arg->phases->mutex);
+  }
+  trace_end("import");
   mt_learn_ret *ret = new mt_learn_ret;
-  ret->status = sat_solver.thread_learn(arg->n_conflict_to_return, &arg->time_to_ret);
+  bool *time_to_ret = arg->deterministic ? &thread_arg->time_to_ret : &arg->time_to_ret;
+  trace_begin("search");
+  ret->status = sat_solver->thread_learn(arg->n_conflict_to_return, time_to_ret);
+  trace_end("search");
+  sat_solver->get_stats(ret->n_conflict, ret->n_decision, ret->n_assign);
+  ret->solver = NULL;
 
-  if(ret->status == SAT || ret->status == UNSAT){
+  if((ret->status == SAT || ret->status == UNSAT) && arg->deterministic){
+    /* main picks the lowest finished thread, whoever got here first */
+    ret->solver = sat_solver;
+    return ret;
+  }
+  else if(ret->status == SAT || ret->status == UNSAT){
     pthread_mutex_lock(arg->mutex);
-    sat_solver.write_result_file(arg->result_file_name);
+    sat_solver->write_result_file(arg->result_file_name, arg->n_out_var);
+    if(arg->proof != NULL)
+      arg->proof->close();
 
     clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
     printf("\nthread %d finished. %f sec\n", pthread_self(), diff_time_sec(&sat_start_time, &sat_end_time));
     exit(0);
   }
-  else
-    sat_solver.get_learnt_clause(ret->learnt_clause);
+  else{
+    trace_begin("export");
+    sat_solver->get_learnt_clause(ret->learnt_clause, ret->learnt_lbd);
+    if(!arg->deterministic) // main filters in thread order instead
+      filter_export(arg, ret->learnt_clause, ret->learnt_lbd);
+    sat_solver->get_best_phase(ret->best_phase, ret->best_trail);
+    if(arg->keep_activity)
+      sat_solver->get_activity(ret->activity);
+    trace_end("export");
+  }
 
+  delete sat_solver;
+  if(arg->governor != NULL)
+    arg->governor->report(thread_arg->idx, 0);
+  trace_end("round");
   return (void *)ret;
 }
 
+void filter_export(mt_arg *arg, vector<vector<int> > &clause, vector<int> &lbd){
+  /* drop clauses some thread already shared and those memory pressure would reduce */
+  bool reduce = arg->governor != NULL && arg->governor->pressure() >= MEM_HIGH;
+  unsigned n_kept = 0;
+  for(unsigned j=0; j<clause.size(); ++j){
+    if(reduce && clause.at(j).size() > 2 && lbd.at(j) > MEM_KEEP_LBD)
+      continue;
+    if(!arg->filter->insert(clause.at(j)))
+      continue;
+    clause.at(n_kept).swap(clause.at(j));
+    lbd.at(n_kept) = lbd.at(j);
+    ++n_kept;
+  }
+  clause.resize(n_kept);
+  lbd.resize(n_kept);
+}
+
 void *mt_solve(void *arg_in){
   mt_arg *arg = (mt_arg *)arg_in;
+  trace_lane("solve", 0);
 
   sat sat_solver(*(arg->clause_db), arg->max_var_idx, arg->ori_db_size, time(NULL)+pthread_self(), arg->restart_chance, arg->numerator, arg->denominator);
-  sat_solver.solve();
+  sat_solver.set_proof(arg->proof);
+  sat_solver.set_governor(arg->governor, 0);
+  sat_solver.set_gauss(arg->gauss);
+  sat_solver.set_amo(arg->amo);
+  if(arg->warm != NULL)
+    sat_solver.set_warm_start(*arg->warm);
+  sat_solver.set_chrono(arg->chrono);
+  sat_solver.set_branch(thread_branch(arg->branch, 0));
+  bool never_stop = false;
+  trace_begin("search");
+  sat_solver.solve(&never_stop);
+  trace_end("search");
 
   pthread_mutex_lock(arg->mutex);
-  sat_solver.write_result_file(arg->result_file_name);
+  sat_solver.write_result_file(arg->result_file_name, arg->n_out_var);
+  if(arg->proof != NULL)
+    arg->proof->close();
 
   clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
   printf("\nthread solve finished. %f sec\n", diff_time_sec(&sat_start_time, &sat_end_time));
@@ -636,25 +1328,496 @@ void *mt_solve(void *arg_in){
   return (void *)NULL;
 }
 
+void enumerate_models(mt_arg *arg, const vector<int> &project, long max_models, unsigned int seed){
+  /* one solver kept from model to model, the models streamed to the result file */
+  sat sat_solver(*(arg->clause_db), arg->max_var_idx, arg->ori_db_size, seed, arg->restart_chance, arg->numerator, arg->denominator);
+  sat_solver.set_gauss(arg->gauss);
+  sat_solver.set_amo(arg->amo);
+  sat_solver.set_chrono(arg->chrono);
+  sat_solver.set_branch(thread_branch(arg->branch, 0));
+  char *filename = arg->result_file_name;
+  int len = strlen(filename);
+  filename[len-3] = 's'; filename[len-2] = 'a'; filename[len-1] = 't';
+  ofstream fout(filename);
+  long n_model = sat_solver.enumerate(project, max_models, fout);
+  bool limited = max_models > 0 && n_model == max_models;
+  fout << "c " << n_model << (limited ? " models, limit reached\n" : " models, all found\n");
+  fout << (n_model > 0 ? "s SATISFIABLE\n" : "s UNSATISFIABLE\n");
+  fout.close();
+
+  clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
+  printf("\n%ld models%s. %f sec\n", n_model, limited ? " (limit)" : "", diff_time_sec(&sat_start_time, &sat_end_time));
+}
+
+void *mt_sls(void *arg_in){
+  /* local search until a model is found, trading phases with the cdcl threads */
+  mt_sls_arg *sls_arg = static_cast<mt_sls_arg *>(arg_in);
+  sls *sls_solver = sls_arg->sls_solver;
+  mt_arg *arg = sls_arg->arg;
+  trace_lane("sls", sls_arg->idx);
+
+  while(true){
+    trace_begin("flips");
+    bool solved = sls_solver->run(SLS_FLIPS_PER_ROUND);
+    trace_end("flips");
+    if(solved)
+      break;
+    sls_exchange(sls_arg);
+  }
+
+  pthread_mutex_lock(arg->mutex);
+  sls_solver->write_result_file(arg->result_file_name, arg->n_out_var);
+  if(arg->proof != NULL)
+    arg->proof->close();
+
+  clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
+  printf("\nthread sls finished. %f sec\n", diff_time_sec(&sat_start_time, &sat_end_time));
+  exit(0);
+
+  return NULL;
+}
+
+void *mt_sls_step(void *arg_in){
+  /* deterministic mode: one batch of flips per round, exchanged by main */
+  mt_sls_arg *sls_arg = static_cast<mt_sls_arg *>(arg_in);
+  trace_lane("sls", sls_arg->idx);
+  trace_begin("flips");
+  sls_arg->solved = sls_arg->sls_solver->run(sls_arg->max_flips);
+  trace_end("flips");
+  return NULL;
+}
+
+void sls_exchange(mt_sls_arg *sls_arg){
+  /* publish the best sls assignment, or restart from the cdcl trail when stuck */
+  sls *sls_solver = sls_arg->sls_solver;
+  phase_pool *phases = sls_arg->arg->phases;
+  bool improved = false;
+  vector<int> cdcl_phase;
+  trace_begin("exchange");
+  pthread_mutex_lock(&phases->mutex);
+  if(phases->sls_unsat < 0 || sls_solver->best_unsat() < phases->sls_unsat){
+    sls_solver->get_best_phase(phases->sls_phase);
+    phases->sls_unsat = sls_solver->best_unsat();
+    improved = true;
+  }
+  if(!improved && phases->cdcl_version != sls_arg->seen_version){
+    cdcl_phase = phases->cdcl_phase;
+    sls_arg->seen_version = phases->cdcl_version;
+  }
+  pthread_mutex_unlock(&phases->mutex);
+  if(!cdcl_phase.empty())
+    sls_solver->set_phase(cdcl_phase);
+  trace_end("exchange");
+}
+
+void *mt_cube(void *arg_in){
+  /* solve cubes from the queue, splitting those that run out of budget */
+  mt_cube_arg *cube_arg = static_cast<mt_cube_arg *>(arg_in);
+  mt_arg *arg = cube_arg->arg;
+  cube_tree *tree = cube_arg->tree;
+  cube_queue *queue = cube_arg->queue;
+  trace_lane("cube", cube_arg->worker);
+
+  sat sat_solver(*(arg->clause_db), arg->max_var_idx, arg->ori_db_size, time(NULL)+pthread_self(), 0, arg->numerator, arg->denominator);
+  sat_solver.set_proof(arg->proof);
+  sat_solver.set_governor(arg->governor, cube_arg->worker);
+  sat_solver.set_gauss(arg->gauss);
+  sat_solver.set_amo(arg->amo);
+  if(arg->warm != NULL)
+    sat_solver.set_warm_start(*arg->warm);
+  sat_solver.set_chrono(arg->chrono);
+  sat_solver.set_branch(thread_branch(arg->branch, cube_arg->worker));
+  unsigned shared_cursor = 0;
+  bool never_stop = false;
+  while(!tree->is_refuted(0)){
+    int node;
+    if(!queue->pop(cube_arg->worker, node)){
+      usleep(1000); // every open cube is being solved, one may get split
+      continue;
+    }
+    if(tree->is_refuted(node))
+      continue;
+
+    vector<vector<int> > shared;
+    tree->get_shared(shared_cursor, shared);
+    for(vector<vector<int> >::iterator cit=shared.begin(); cit!=shared.end(); ++cit)
+      sat_solver.import_clause(*cit);
+
+    vector<int> cube;
+    tree->get_lits(node, cube);
+    trace_begin("cube");
+    int status = sat_solver.solve_cube(cube, CUBE_CONFLICT_BUDGET, &never_stop);
+    trace_end("cube");
+    if(status == SAT)
+      break;
+
+    /* lemmas go to the proof before anything that depends on them */
+    trace_begin("share");
+    sat_solver.flush_proof();
+    vector<vector<int> > short_learnt, fresh;
+    sat_solver.get_short_learnt(short_learnt);
+    for(vector<vector<int> >::iterator cit=short_learnt.begin(); cit!=short_learnt.end(); ++cit)
+      if(arg->filter->insert(*cit))
+        fresh.push_back(*cit);
+    tree->share(fresh); // own clauses come back once, harmless
+    trace_end("share");
+
+    if(status == UNSAT){
+      if(tree->refute(node))
+        break;
+      continue;
+    }
+    int split_var = sat_solver.pick_split_var(cube);
+    if(split_var == 0){
+      queue->push(cube_arg->worker, node);
+      continue;
+    }
+    int pos_child = tree->add_child(node, split_var);
+    int neg_child = tree->add_child(node, -split_var);
+    queue->push(cube_arg->worker, neg_child);
+    queue->push(cube_arg->worker, pos_child);
+  }
+
+  pthread_mutex_lock(arg->mutex);
+  sat_solver.write_result_file(arg->result_file_name, arg->n_out_var);
+  if(arg->proof != NULL)
+    arg->proof->close();
+
+  clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
+  printf("\nthread cube %d finished. %f sec\n", cube_arg->worker, diff_time_sec(&sat_start_time, &sat_end_time));
+  exit(0);
+
+  return NULL;
+}
+
+void *mt_serve(void *arg_in){
+  /* a pool worker of the server, one job at a time on a fresh solver */
+  mt_serve_arg *serve_arg = static_cast<mt_serve_arg *>(arg_in);
+  while(true){
+    server_job *job = serve_arg->server->next();
+    if(!job->stopped())
+      solve_job(serve_arg, job);
+    vector<vector<int> >().swap(job->clause_db);
+    serve_arg->server->finish(job);
+  }
+  return NULL;
+}
+
+void solve_job(mt_serve_arg *serve_arg, server_job *job){
+  /* the preprocessing of main without symmetry, then one solver until job->stop */
+  mt_arg *arg = serve_arg->arg;
+  for(vector<vector<int> >::iterator cit=job->clause_db.begin(); cit!=job->clause_db.end(); ++cit)
+    if(cit->empty()){
+      job->answer = JOB_UNSAT;
+      return;
+    }
+  if(job->max_var_idx == 0){
+    job->model.assign(1, UNASSIGNED);
+    job->answer = JOB_SAT;
+    return;
+  }
+  vector<vector<int> > amo_groups;
+  if(serve_arg->use_amo){
+    int n_exactly_one;
+    find_amo_groups(job->clause_db, job->max_var_idx, amo_groups, n_exactly_one);
+  }
+  int ori_db_size = job->clause_db.size();
+  vector<xor_constraint> xors;
+  if(serve_arg->use_xor)
+    find_xors(job->clause_db, ori_db_size, xors);
+  gauss_matrix *gauss = xors.empty() ? NULL : new gauss_matrix(xors, job->max_var_idx);
+
+  sat sat_solver(job->clause_db, job->max_var_idx, ori_db_size, time(NULL)+job->id, arg->restart_chance, arg->numerator, arg->denominator);
+  sat_solver.set_gauss(gauss);
+  delete gauss;
+  sat_solver.set_amo(amo_groups.empty() ? NULL : &amo_groups);
+  sat_solver.set_chrono(arg->chrono);
+  sat_solver.set_branch(thread_branch(arg->branch, serve_arg->worker));
+  int status = sat_solver.solve(&job->stop, &job->stop_mutex);
+  if(status == SAT && sat_solver.get_model(job->model))
+    job->answer = JOB_SAT;
+  else if(status == UNSAT)
+    job->answer = JOB_UNSAT;
+}
+
+unsigned int derive_seed(unsigned int master, int round, int thread){
+  /* mix so that neighbouring rounds and threads get unrelated streams */
+  unsigned int x = master ^ (round * 0x9e3779b9u) ^ (thread * 0x85ebca6bu);
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
+}
+
+int thread_branch(int branch, int thread){
+  /* BRANCH_MIX cycles the heuristics over the threads, thread 0 keeps vsids */
+  return branch == BRANCH_MIX ? thread % BRANCH_MIX : branch;
+}
+
+bool parse_var_list(const char *list, vector<int> &fill_vars){
+  /* comma separated vars and ranges, e.g. 1-81,100, sorted without repeats */
+  const char *p = list;
+  while(*p != '\0'){
+    char *end;
+    long first = strtol(p, &end, 10);
+    long last = first;
+    if(end == p || first <= 0)
+      return false;
+    if(*end == '-'){
+      p = end + 1;
+      last = strtol(p, &end, 10);
+      if(end == p || last < first)
+        return false;
+    }
+    for(long v=first; v<=last; ++v)
+      fill_vars.push_back(v);
+    if(*end == ',')
+      ++end;
+    else if(*end != '\0')
+      return false;
+    p = end;
+  }
+  sort(fill_vars.begin(), fill_vars.end());
+  fill_vars.erase(unique(fill_vars.begin(), fill_vars.end()), fill_vars.end());
+  return !fill_vars.empty();
+}
+
+int save_checkpoint(const char *filename, uint64_t hash, int n_var, const vector<vector<int> > &clause_db, const vector<int> &clause_lbd, int ori_db_size, const vector<int> &phase, const vector<double> &activity){
+  /* the good shared clauses, the longest trail and the activities of its thread; -1 if not written */
+  checkpoint state;
+  state.keep_learnt(clause_db, clause_lbd, ori_db_size);
+  state.phase = phase;
+  if(!activity.empty())
+    state.rank_activity(activity);
+  if(!write_checkpoint(filename, hash, n_var, state))
+    return -1;
+  return state.clause.size();
+}
+
+void on_stop_signal(int sig){
+  /* main writes the checkpoint once the round is joined */
+  stop_signal = sig;
+  if(stop_round != NULL)
+    *stop_round = true;
+}
+
 double diff_time_sec(struct timespec *start, struct timespec *end){
   double diff = end->tv_sec - start->tv_sec + double(end->tv_nsec - start->tv_nsec) / 1e9;
   return diff;
 }
 
+void print_usage(){
+  cout << "Usage: ./yasat [options] cnf_file_path\n"
+       << "  --drat=FILE    write a DRAT proof of UNSAT answers to FILE (binary)\n"
+       << "  --drat-text    write the DRAT proof as text instead\n"
+       << "  --sls=N        run N local search workers (default 1)\n"
+       << "  --sls-mode=M   probsat (default), walksat or anneal\n"
+       << "  --threads=N    number of cdcl threads (default 16)\n"
+       << "  --seed=N       deterministic mode: all randomness derived from N,\n"
+       << "                 clauses exchanged after a fixed number of conflicts\n"
+       << "  --cube         cube and conquer: split by lookahead, threads solve cubes\n"
+       << "  --mem-limit=MB shrink learnt clauses, sharing and threads near MB\n"
+       << "  --symmetry[=S] add symmetry breaking clauses, searching up to S sec (default 1)\n"
+       << "  --no-xor       no gaussian elimination over xors found in the clauses\n"
+       << "  --no-amo       keep at-most-one constraints as pairwise binary clauses\n"
+       << "  --chrono[=T]   backjumps over more than T levels (default 100) undo one level\n"
+       << "  --branch=B     vsids (default), vmtf, lrb, switch (vmtf, lrb once restarts\n"
+       << "                 are far apart) or mix (the threads cycle through them)\n"
+       << "  --portfolio=P  bandit (default): learn threads move to the restart, random\n"
+       << "                 branch and, with mix, heuristic settings doing best; fixed:\n"
+       << "                 all on one schedule\n"
+       << "  --enum[=N]     write up to N models (default all) to the result file, one thread\n"
+       << "  --project=L    with --enum, models differ on the vars of L, e.g. 1-81,100\n"
+       << "  --checkpoint=FILE  keep good learnt clauses, phases and activities in FILE,\n"
+       << "                 every 60 sec, at the time limit and on SIGTERM or SIGINT\n"
+       << "  --warm-start=FILE  start every thread from the checkpoint in FILE\n"
+       << "  --server=PATH  serve jobs on the unix socket PATH, --threads workers\n"
+       << "                 (SOLVE, CANCEL, STATS and QUIT, see server.cpp)\n"
+       << "  --job-time=S   default and longest time of a server job, queue wait\n"
+       << "                 included (default 60)\n"
+       << "  --trace=FILE   write a chrome trace json timeline of every thread to FILE\n"
+       << "                 at exit (chrome://tracing or perfetto; not in server mode)\n";
+}
+
 int main(int argc, char *argv[]){
-  if(argc != 2){
-    cout << "Usage: ./yasat cnf_file_path\n";
+  char *cnf_file = NULL;
+  char *drat_file = NULL;
+  bool drat_binary = true;
+  int n_sls = 1;
+  int sls_mode = SLS_PROBSAT;
+  int n_thread = 16;
+  bool deterministic = false;
+  unsigned int master_seed = 0;
+  bool cube_mode = false;
+  long mem_limit = 0;
+  double symmetry_budget = -1; // off
+  bool use_xor = true;
+  bool use_amo = true;
+  int chrono = 0; // off
+  int branch = BRANCH_VSIDS;
+  int portfolio_mode = PORTFOLIO_BANDIT;
+  long max_models = -1; // no enumeration
+  vector<int> project;
+  char *server_path = NULL;
+  double job_time = SERVER_JOB_TIME;
+  char *checkpoint_file = NULL;
+  char *warm_file = NULL;
+  char *trace_file = NULL;
+  for(int i=1; i<argc; ++i){
+    if(strncmp(argv[i], "--drat=", 7) == 0)
+      drat_file = argv[i] + 7;
+    else if(strcmp(argv[i], "--drat-text") == 0)
+      drat_binary = false;
+    else if(strncmp(argv[i], "--sls=", 6) == 0)
+      n_sls = atoi(argv[i] + 6);
+    else if(strcmp(argv[i], "--sls-mode=probsat") == 0)
+      sls_mode = SLS_PROBSAT;
+    else if(strcmp(argv[i], "--sls-mode=walksat") == 0)
+      sls_mode = SLS_WALKSAT;
+    else if(strcmp(argv[i], "--sls-mode=anneal") == 0)
+      sls_mode = SLS_ANNEAL;
+    else if(strncmp(argv[i], "--threads=", 10) == 0)
+      n_thread = atoi(argv[i] + 10);
+    else if(strcmp(argv[i], "--cube") == 0)
+      cube_mode = true;
+    else if(strcmp(argv[i], "--symmetry") == 0)
+      symmetry_budget = SYMMETRY_TIME_BUDGET;
+    else if(strncmp(argv[i], "--symmetry=", 11) == 0)
+      symmetry_budget = atof(argv[i] + 11);
+    else if(strcmp(argv[i], "--no-xor") == 0)
+      use_xor = false;
+    else if(strcmp(argv[i], "--no-amo") == 0)
+      use_amo = false;
+    else if(strcmp(argv[i], "--chrono") == 0)
+      chrono = CHRONO_THRESHOLD;
+    else if(strncmp(argv[i], "--chrono=", 9) == 0)
+      chrono = atoi(argv[i] + 9);
+    else if(strcmp(argv[i], "--branch=vsids") == 0)
+      branch = BRANCH_VSIDS;
+    else if(strcmp(argv[i], "--branch=vmtf") == 0)
+      branch = BRANCH_VMTF;
+    else if(strcmp(argv[i], "--branch=lrb") == 0)
+      branch = BRANCH_LRB;
+    else if(strcmp(argv[i], "--branch=switch") == 0)
+      branch = BRANCH_SWITCH;
+    else if(strcmp(argv[i], "--branch=mix") == 0)
+      branch = BRANCH_MIX;
+    else if(strcmp(argv[i], "--portfolio=fixed") == 0)
+      portfolio_mode = PORTFOLIO_FIXED;
+    else if(strcmp(argv[i], "--portfolio=bandit") == 0)
+      portfolio_mode = PORTFOLIO_BANDIT;
+    else if(strcmp(argv[i], "--enum") == 0)
+      max_models = 0;
+    else if(strncmp(argv[i], "--enum=", 7) == 0){
+      char *end;
+      max_models = strtol(argv[i] + 7, &end, 10);
+      if(end == argv[i] + 7 || *end != '\0' || max_models <= 0){
+        print_usage();
+        exit(1);
+      }
+    }
+    else if(strncmp(argv[i], "--project=", 10) == 0){
+      if(!parse_var_list(argv[i] + 10, project)){
+        print_usage();
+        exit(1);
+      }
+    }
+    else if(strncmp(argv[i], "--server=", 9) == 0)
+      server_path = argv[i] + 9;
+    else if(strncmp(argv[i], "--job-time=", 11) == 0)
+      job_time = atof(argv[i] + 11);
+    else if(strncmp(argv[i], "--checkpoint=", 13) == 0)
+      checkpoint_file = argv[i] + 13;
+    else if(strncmp(argv[i], "--warm-start=", 13) == 0)
+      warm_file = argv[i] + 13;
+    else if(strncmp(argv[i], "--trace=", 8) == 0)
+      trace_file = argv[i] + 8;
+    else if(strncmp(argv[i], "--mem-limit=", 12) == 0)
+      mem_limit = atol(argv[i] + 12) << 20;
+    else if(strncmp(argv[i], "--seed=", 7) == 0){
+      deterministic = true;
+      master_seed = strtoul(argv[i] + 7, NULL, 10);
+    }
+    else if(argv[i][0] != '-' && cnf_file == NULL)
+      cnf_file = argv[i];
+    else{
+      print_usage();
+      exit(1);
+    }
+  }
+  if(server_path != NULL && n_thread >= 1 && job_time > 0){
+    /* the pool outlives the jobs; symmetry, proofs, cubes and checkpoints are per run options */
+    job_server server(SERVER_QUEUE_LIMIT, SERVER_MAX_CLIENTS);
+    mt_arg arg(NULL, 0, 0, 10000, 256, 512, 0, NULL, NULL);
+    arg.chrono = chrono;
+    arg.branch = branch;
+    vector<mt_serve_arg> serve_arg(n_thread);
+    for(int i=0; i<n_thread; ++i){
+      serve_arg[i].server = &server;
+      serve_arg[i].arg = &arg;
+      serve_arg[i].use_xor = use_xor;
+      serve_arg[i].use_amo = use_amo;
+      serve_arg[i].worker = i;
+      pthread_t tid;
+      pthread_create(&tid, NULL, &mt_serve, &serve_arg[i]);
+    }
+    return serve(server_path, &server, job_time);
+  }
+  if(cnf_file == NULL || n_thread < (cube_mode ? 1 : 2)){
+    print_usage();
     exit(1);
   }
   clock_gettime(CLOCK_MONOTONIC, &sat_start_time);
+  if(trace_file != NULL)
+    trace_open(trace_file);
 
   vector<vector<int> > clause_db;
-  int maxVarIndex;
-  parse_DIMACS_CNF(clause_db, maxVarIndex, argv[1]);
+  int maxVarIndex, headerVars;
+  trace_begin("parse");
+  parse_DIMACS_CNF(clause_db, maxVarIndex, headerVars, cnf_file);
+  trace_end("parse");
+  if(max_models >= 0) // declared vars in no clause double the models
+    maxVarIndex = max(maxVarIndex, headerVars);
+  int n_out_var = maxVarIndex;
+  if(symmetry_budget >= 0 && drat_file != NULL)
+    printf("\nsymmetry breaking clauses have no DRAT proof, skipped\n");
+  else if(symmetry_budget >= 0 && max_models >= 0)
+    printf("\nsymmetry breaking clauses drop models, skipped\n");
+  else if(symmetry_budget >= 0){
+    /* the breaking clauses count as original: never reduced, checked by _verify */
+    int n_generator;
+    trace_begin("symmetry");
+    int n_added = break_symmetry(clause_db, maxVarIndex, deterministic ? 0 : symmetry_budget, n_generator);
+    trace_end("symmetry");
+    clock_gettime(CLOCK_MONOTONIC, &sat_cur_time);
+    printf("\n%d symmetry generators, %d breaking clauses. %f sec\n", n_generator, n_added, diff_time_sec(&sat_start_time, &sat_cur_time));
+  }
+  /* checkpoints belong to the formula with its breaking clauses, before the groups take binaries out */
+  uint64_t formula = formula_hash(clause_db, clause_db.size());
+  /* the groups explain by their original binary clauses, fine with DRAT */
+  vector<vector<int> > amo_groups;
+  if(use_amo){
+    int n_exactly_one;
+    trace_begin("amo");
+    int n_removed = find_amo_groups(clause_db, maxVarIndex, amo_groups, n_exactly_one);
+    trace_end("amo");
+    clock_gettime(CLOCK_MONOTONIC, &sat_cur_time);
+    if(!amo_groups.empty())
+      printf("\n%lu at-most-one groups (%d exactly-one) for %d binary clauses. %f sec\n", amo_groups.size(), n_exactly_one, n_removed, diff_time_sec(&sat_start_time, &sat_cur_time));
+  }
   int ori_db_size = clause_db.size();
+  /* lookahead and sls only know clauses, they get the groups back pairwise */
+  vector<vector<int> > pairwise_db;
+  if(!amo_groups.empty() && (cube_mode || n_sls > 0)){
+    pairwise_db.assign(clause_db.begin(), clause_db.end());
+    expand_amo_groups(amo_groups, pairwise_db);
+  }
+  vector<vector<int> > &clause_only_db = amo_groups.empty() ? clause_db : pairwise_db;
+  int clause_only_size = clause_only_db.size();
 
   //int n_thread = sysconf(_SC_NPROCESSORS_ONLN);
-  int n_thread = 16;
   int restart_chance = 1e6; // decay
   int numerator = 128; // decay 
   int denominator = 256; // decay
@@ -662,48 +1825,297 @@ int main(int argc, char *argv[]){
   int n_conflict_to_return_bound = 128; // increasing
   int n_timestep_to_change = 5;
   pthread_mutex_t mutex;
+  pthread_mutex_init(&mutex, NULL);
   pthread_t tid[n_thread];
-  mt_arg arg(&clause_db, maxVarIndex, ori_db_size, 10000, 256, 512, 0, argv[1], &mutex);
+  mt_arg arg(&clause_db, maxVarIndex, ori_db_size, 10000, 256, 512, 0, cnf_file, &mutex);
+  arg.deterministic = deterministic;
+  arg.n_out_var = n_out_var;
+  arg.chrono = chrono;
+  arg.branch = branch;
+  mem_governor governor(mem_limit, n_thread + 1); // the last slot is the shared clause_db
+  if(governor.enabled())
+    arg.governor = &governor;
+  clause_filter filter(DEDUP_TABLE_BITS);
+  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit)
+    filter.insert(*cit);
+  arg.filter = &filter;
+  if(!amo_groups.empty())
+    arg.amo = &amo_groups;
+  vector<xor_constraint> xors;
+  trace_begin("xor");
+  if(use_xor && drat_file == NULL) // learnt clauses resolved on xor rows may not be RUP
+    find_xors(clause_db, ori_db_size, xors);
+  if(!xors.empty())
+    arg.gauss = new gauss_matrix(xors, maxVarIndex);
+  trace_end("xor");
+  if(!xors.empty()){
+    clock_gettime(CLOCK_MONOTONIC, &sat_cur_time);
+    printf("\n%lu xor constraints. %f sec\n", xors.size(), diff_time_sec(&sat_start_time, &sat_cur_time));
+  }
+  if(max_models >= 0){
+    if(drat_file != NULL)
+      printf("\nblocking clauses have no DRAT proof, none written\n");
+    for(vector<int>::iterator vit=project.begin(); vit!=project.end(); ++vit)
+      if(*vit > n_out_var){
+        printf("\nvar %d of --project is above the %d vars of the formula\n", *vit, n_out_var);
+        exit(1);
+      }
+    enumerate_models(&arg, project, max_models, deterministic ? derive_seed(master_seed, 0, 0) : time(NULL));
+    exit(0);
+  }
+  if(drat_file != NULL){
+    arg.proof = new drat_writer(drat_file, drat_binary);
+    if(!arg.proof->is_open())
+      exit(1);
+  }
 
-  /* thread solve */
-  pthread_create(&tid[0], NULL, &mt_solve, (void *)&arg);
+  /* the saved clauses go after the original ones, learnt as far as every solver is concerned */
+  checkpoint warm;
+  if(warm_file != NULL && drat_file != NULL)
+    printf("\ncheckpoint clauses have no DRAT proof, warm start skipped\n");
+  else if(warm_file != NULL){
+    int status = read_checkpoint(warm_file, formula, maxVarIndex, warm);
+    if(status == CHECKPOINT_OK){
+      unsigned n_kept = 0;
+      for(unsigned c=0; c<warm.clause.size(); ++c){
+        if(!filter.insert(warm.clause.at(c)))
+          continue;
+        clause_db.push_back(vector<int>());
+        clause_db.back().swap(warm.clause.at(c));
+        warm.lbd.at(n_kept++) = warm.lbd.at(c);
+      }
+      warm.lbd.resize(n_kept);
+      vector<vector<int> >().swap(warm.clause);
+      arg.warm = &warm;
+      printf("\nwarm start: %u learnt clauses from %s\n", n_kept, warm_file);
+    }
+    else if(status == CHECKPOINT_MISSING)
+      printf("\nwarm start: no %s yet, starting cold\n", warm_file);
+    else if(status == CHECKPOINT_OTHER_FORMULA)
+      printf("\nwarm start: %s is for another formula, starting cold\n", warm_file);
+    else
+      printf("\nwarm start: %s is damaged, starting cold\n", warm_file);
+  }
+
+  if(cube_mode){
+    if(checkpoint_file != NULL)
+      printf("\nno checkpoints in cube mode\n");
+    cube_tree tree(arg.proof);
+    cube_queue queue(n_thread);
+    vector<int> leaves;
+    trace_begin("lookahead");
+    build_cubes(clause_only_db, maxVarIndex, clause_only_size, n_thread * CUBES_PER_THREAD, tree, leaves);
+    trace_end("lookahead");
+    printf("\n%lu cubes\n", leaves.size());
+    for(unsigned i=0; i<leaves.size(); ++i)
+      queue.push(i % n_thread, leaves.at(i));
+    vector<mt_cube_arg> cube_arg(n_thread);
+    for(int i=0; i<n_thread; ++i){
+      cube_arg[i].arg = &arg;
+      cube_arg[i].tree = &tree;
+      cube_arg[i].queue = &queue;
+      cube_arg[i].worker = i;
+      pthread_create(&tid[i], NULL, &mt_cube, &cube_arg[i]);
+    }
+    for(int i=0; i<n_thread; ++i)
+      pthread_join(tid[i], NULL);
+    return 0;
+  }
+
+  phase_pool phases;
+  arg.phases = &phases;
+
+  /* thread solve, it would race the rounds so deterministic mode goes without */
+  if(!deterministic)
+    pthread_create(&tid[0], NULL, &mt_solve, (void *)&arg);
+
+  /* thread sls, built here while clause_db is still the original formula */
+  vector<pthread_t> sls_tid(n_sls > 0 ? n_sls : 0);
+  vector<mt_sls_arg> sls_arg(n_sls > 0 ? n_sls : 0);
+  for(int i=0; i<n_sls; ++i){
+    unsigned int seed = deterministic ? derive_seed(master_seed, 0, n_thread + i) : time(NULL)+i;
+    sls_arg[i].sls_solver = new sls(clause_only_db, maxVarIndex, clause_only_size, seed, sls_mode);
+    sls_arg[i].arg = &arg;
+    sls_arg[i].idx = i;
+    sls_arg[i].seen_version = 0;
+    sls_arg[i].solved = false;
+    if(!deterministic)
+      pthread_create(&sls_tid[i], NULL, &mt_sls, &sls_arg[i]);
+  }
+  vector<vector<int> >().swap(pairwise_db);
+  long n_conflict = 0, n_decision = 0, n_assign = 0;
+  vector<mt_thread_arg> thread_arg(n_thread);
 
   /* thread mt_learn */
-  map<vector<int>, bool> hash_map;
-  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit){
-    hash_map[*cit] = true;
+  vector<int> clause_lbd(ori_db_size, 0); // glue of the shared learnt clauses
+  clause_lbd.insert(clause_lbd.end(), warm.lbd.begin(), warm.lbd.end());
+  long shared_bytes = filter.bytes(); // clause_db and the filter
+  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit)
+    shared_bytes += mem_governor::clause_bytes(*cit);
+  governor.report(n_thread, shared_bytes);
+  drat_buffer *shared_proof = arg.proof == NULL ? NULL : new drat_buffer(arg.proof);
+  int n_active = n_thread; // learn threads are 1 .. n_active-1, fewer under memory pressure
+  vector<double> best_activity; // of the thread with the longest trail in the last round
+  portfolio bandit(branch);
+  vector<int> arms; // by learn thread 1 .. n_active-1 of the round
+  vector<worker_progress> progress;
+  struct timespec checkpoint_time = sat_start_time;
+  if(checkpoint_file != NULL){
+    arg.keep_activity = true;
+    if(!deterministic) // deterministic rounds end on their budgets
+      stop_round = &arg.time_to_ret;
+    signal(SIGTERM, on_stop_signal);
+    signal(SIGINT, on_stop_signal);
   }
 
   printf("\n");
   for(int timestep=1; timestep<65536; ++timestep){
+    trace_begin("round");
     arg.clause_db = &clause_db;
     arg.restart_chance = restart_chance;
     arg.numerator = numerator;
     arg.denominator = denominator;
     arg.n_conflict_to_return = n_conflict_to_return;
     arg.time_to_ret = false;
-    for(int i=1; i<n_thread; ++i){
-      pthread_create(&tid[i], NULL, &mt_learn, (void *)&arg);
+    if(portfolio_mode == PORTFOLIO_BANDIT)
+      bandit.assign(n_active - 1, arms);
+    for(int i=1; i<n_active; ++i){
+      thread_arg[i].arg = &arg;
+      thread_arg[i].idx = i;
+      thread_arg[i].seed = derive_seed(master_seed, timestep, i);
+      thread_arg[i].time_to_ret = false;
+      if(portfolio_mode == PORTFOLIO_BANDIT){
+        thread_arg[i].arm = arms[i-1];
+        thread_arg[i].settings = bandit.arm(arms[i-1]);
+      }
+      else{
+        thread_arg[i].arm = -1;
+        thread_arg[i].settings.restart_chance = restart_chance;
+        thread_arg[i].settings.numerator = numerator;
+        thread_arg[i].settings.denominator = denominator;
+        thread_arg[i].settings.branch = thread_branch(branch, i);
+      }
+      pthread_create(&tid[i], NULL, &mt_learn, &thread_arg[i]);
+    }
+    for(int i=0; i<n_sls && deterministic; ++i){
+      sls_arg[i].max_flips = SLS_FLIPS_PER_CONFLICT * n_conflict_to_return;
+      pthread_create(&sls_tid[i], NULL, &mt_sls_step, &sls_arg[i]);
     }
 
     mt_learn_ret *ret[n_thread];
-    for(int i=1; i<n_thread; ++i){
+    trace_begin("join");
+    for(int i=1; i<n_active; ++i){
       pthread_join(tid[i], (void**)&ret[i]);
+      n_conflict += ret[i]->n_conflict;
+      n_decision += ret[i]->n_decision;
+      n_assign += ret[i]->n_assign;
+    }
+    for(int i=0; i<n_sls && deterministic; ++i)
+      pthread_join(sls_tid[i], NULL);
+    trace_end("join");
+    if(deterministic){
+      for(int i=1; i<n_active; ++i){
+        if(ret[i]->solver == NULL)
+          continue;
+        printf("\nc seed %u rounds %d conflicts %ld decisions %ld assignments %ld\n", master_seed, timestep, n_conflict, n_decision, n_assign);
+        ret[i]->solver->write_result_file(arg.result_file_name, arg.n_out_var);
+        if(arg.proof != NULL)
+          arg.proof->close();
+        clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
+        printf("\nthread %d finished. %f sec\n", i, diff_time_sec(&sat_start_time, &sat_end_time));
+        exit(0);
+      }
+      for(int i=0; i<n_sls; ++i){
+        if(!sls_arg[i].solved){
+          sls_exchange(&sls_arg[i]);
+          continue;
+        }
+        printf("\nc seed %u rounds %d conflicts %ld decisions %ld assignments %ld\n", master_seed, timestep, n_conflict, n_decision, n_assign);
+        sls_arg[i].sls_solver->write_result_file(arg.result_file_name, arg.n_out_var);
+        if(arg.proof != NULL)
+          arg.proof->close();
+        clock_gettime(CLOCK_MONOTONIC, &sat_end_time);
+        printf("\nthread sls %d finished. %f sec\n", i, diff_time_sec(&sat_start_time, &sat_end_time));
+        exit(0);
+      }
+    }
+
+    /* hand the longest trail of this round to the sls threads */
+    int best_thread = 1;
+    for(int i=2; i<n_active; ++i)
+      if(ret[i]->best_trail > ret[best_thread]->best_trail)
+        best_thread = i;
+    if(ret[best_thread]->best_trail > 0){
+      pthread_mutex_lock(&phases.mutex);
+      phases.cdcl_phase = ret[best_thread]->best_phase;
+      phases.cdcl_trail = ret[best_thread]->best_trail;
+      ++phases.cdcl_version;
+      pthread_mutex_unlock(&phases.mutex);
     }
+    best_activity.swap(ret[best_thread]->activity);
 
+    int pressure = governor.pressure();
     int count = 0;
-    for(int i=1; i<n_thread; ++i){
-      for(vector<vector<int> >::iterator cit=ret[i]->learnt_clause.begin(); cit!=ret[i]->learnt_clause.end(); ++cit){
-        if(hash_map.find(*cit) == hash_map.end()){
-          hash_map[*cit] = true;
-          clause_db.push_back(*cit);
-          ++count;
-        }
-        clause_db.push_back(*cit);
+    trace_begin("merge");
+    progress.assign(n_active - 1, worker_progress());
+    for(int i=1; i<n_active; ++i){
+      if(deterministic)
+        filter_export(&arg, ret[i]->learnt_clause, ret[i]->learnt_lbd);
+      worker_progress &p = progress[i-1];
+      p.best_trail = ret[i]->best_trail;
+      p.n_learnt = ret[i]->learnt_lbd.size();
+      p.n_good = count_if(ret[i]->learnt_lbd.begin(), ret[i]->learnt_lbd.end(), bind2nd(less_equal<int>(), PORTFOLIO_GOOD_LBD));
+      p.n_conflict = ret[i]->n_conflict;
+      p.n_assign = ret[i]->n_assign;
+      for(unsigned j=0; j<ret[i]->learnt_clause.size(); ++j){
+        clause_db.push_back(vector<int>());
+        clause_db.back().swap(ret[i]->learnt_clause.at(j));
+        clause_lbd.push_back(ret[i]->learnt_lbd.at(j));
+        shared_bytes += mem_governor::clause_bytes(clause_db.back());
+        ++count;
       }
       delete ret[i];
       printf("\r[%d/65535] %d clauses added. clause_db_size = %lu..... ", timestep, count, clause_db.size());
     }
+    trace_end("merge");
+    if(portfolio_mode == PORTFOLIO_BANDIT)
+      bandit.update(arms, progress);
+
+    if(pressure >= MEM_HIGH){
+      /* every thread reading clause_db is joined, mt_solve never saw these,
+       * so the deletions are safe to put in the proof */
+      trace_begin("reduce");
+      int n_kept = ori_db_size;
+      for(unsigned c=ori_db_size; c<clause_db.size(); ++c){
+        if(clause_db.at(c).size() > 2 && clause_lbd.at(c) > MEM_KEEP_LBD){
+          filter.erase(clause_db.at(c));
+          if(shared_proof != NULL)
+            shared_proof->del(clause_db.at(c));
+          continue;
+        }
+        clause_db.at(n_kept).swap(clause_db.at(c));
+        clause_lbd.at(n_kept) = clause_lbd.at(c);
+        ++n_kept;
+      }
+      clause_db.resize(n_kept);
+      clause_lbd.resize(n_kept);
+      if(shared_proof != NULL)
+        shared_proof->flush();
+      shared_bytes = filter.bytes();
+      for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit)
+        shared_bytes += mem_governor::clause_bytes(*cit);
+      trace_end("reduce");
+    }
+    governor.report(n_thread, shared_bytes);
+    if(pressure == MEM_CRITICAL && n_active > 2){
+      n_active = 1 + n_active / 2;
+      trace_instant("learn threads", n_active - 1);
+      printf("\nmemory %ld MB, down to %d learn threads\n", governor.used() >> 20, n_active - 1);
+    }
+    else if(pressure == MEM_OK && n_active < n_thread){
+      n_active = min(n_thread, 2 * n_active - 1);
+      trace_instant("learn threads", n_active - 1);
+    }
   
     if(timestep % n_timestep_to_change == 0){
       if(restart_chance > 100)
@@ -719,11 +2131,33 @@ int main(int argc, char *argv[]){
         if(n_conflict_to_return_bound < 65535)
           n_conflict_to_return_bound *= 2;
       }
+      trace_instant("schedule", n_conflict_to_return);
     }
 
     clock_gettime(CLOCK_MONOTONIC, &sat_cur_time);
-    if(diff_time_sec(&sat_start_time, &sat_cur_time) > 900){
+    bool timeout = diff_time_sec(&sat_start_time, &sat_cur_time) > 900;
+    if(checkpoint_file != NULL && (timeout || stop_signal != 0 || diff_time_sec(&checkpoint_time, &sat_cur_time) > CHECKPOINT_INTERVAL)){
+      trace_begin("checkpoint");
+      int n_saved = save_checkpoint(checkpoint_file, formula, maxVarIndex, clause_db, clause_lbd, ori_db_size, phases.cdcl_phase, best_activity);
+      trace_end("checkpoint");
+      checkpoint_time = sat_cur_time;
+      if(timeout || stop_signal != 0)
+        printf("\ncheckpoint: %d learnt clauses to %s\n", n_saved, checkpoint_file);
+    }
+    trace_end("round");
+    if(stop_signal != 0){
+      printf("stopped by signal...\n");
+      fflush(stdout);
+      if(arg.proof != NULL)
+        arg.proof->close();
+      trace_dump(); // the signal ends the process before atexit
+      signal(stop_signal, SIG_DFL);
+      raise(stop_signal);
+    }
+    if(timeout){
       printf("break due to timelimit...\n");
+      if(arg.proof != NULL)
+        arg.proof->close();
       break;
     }
   }
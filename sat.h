@@ -3,6 +3,13 @@
 
 #define UNASSIGNED 0
 #define NO_ANTEC -1
+// lazy reasons below NO_ANTEC: even codes index _xor_reason, odd codes
+// name the true lit of an at-most-one group that forced the var false
+#define XOR_ANTEC(k) (-2 - 2*(k))
+#define XOR_REASON(antec) ((-2 - (antec)) / 2)
+#define AMO_ANTEC(lit_idx) (-3 - 2*(lit_idx))
+#define AMO_LIT_IDX(antec) ((-3 - (antec)) / 2)
+#define IS_AMO_ANTEC(antec) ((antec) < NO_ANTEC && (antec) % 2 != 0)
 
 #define NULL_CLAUSE 0
 #define COULD_ADD 1
@@ -17,6 +24,7 @@
 #define LEARNT_SIZE_HARD_LIMIT 6
 #define N_CONFLICT_TO_RESTART_HARD_LIMIT 65535
 #define DENOMINATOR_HARD_LIMIT 1024
+#define CHRONO_THRESHOLD 100 // backjump distance of --chrono without a value
 
 #define SAT 1
 #define UNSAT 0
@@ -24,18 +32,6 @@
 
 using namespace std;
 
-struct var_info {
-  int value;
-  int score;
-  // the following three only valid when value not UNASSIGNED
-  int level;
-  int antec; // NO_ANTEC means it's a decision
-  int order;
-  vector<int> pos_vec;
-  vector<int> neg_vec;
-  var_info():value(UNASSIGNED), score(0){;};
-};
-
 struct twoidx {
   int idx1;
   int idx2;
@@ -43,12 +39,6 @@ struct twoidx {
   twoidx(int a, int b):idx1(a),idx2(b){;}
 };
 
-struct var_score {
-  int var;
-  int *score;
-  var_score(int v, int *s):var(v),score(s){;}
-};
-
 struct assignment {
   int value;
   int level;
@@ -59,15 +49,31 @@ struct assignment {
 class sat {
 public:
   sat(vector<vector<int> >&, int, int, int, int, int, int);
-  void get_learnt_clause(vector<vector<int> > &);
-  bool solve();
+  ~sat();
+  void set_proof(drat_writer *);
+  void set_governor(mem_governor *, int);
+  void set_gauss(const gauss_matrix *);
+  void set_amo(const vector<vector<int> > *);
+  void set_chrono(int);
+  void set_branch(int);
+  void set_saved_phase(const vector<int> &);
+  void set_warm_start(const checkpoint &);
+  void get_best_phase(vector<int> &, int &);
+  void get_stats(long &, long &, long &);
+  bool get_model(vector<int> &);
+  void get_activity(vector<double> &);
+  void get_learnt_clause(vector<vector<int> > &, vector<int> &);
+  int solve(bool *, pthread_mutex_t * = NULL);
   int thread_learn(int, bool *);
-  void write_result_file(char *);
+  int solve_cube(vector<int> &, int, bool *);
+  long enumerate(const vector<int> &, long, ostream &);
+  int pick_split_var(vector<int> &);
+  void import_clause(vector<int> &);
+  void get_short_learnt(vector<vector<int> > &);
+  void flush_proof();
+  void write_result_file(char *, int);
 private:
   bool _verify();
-  static bool _score_cmp(var_score &vs1, var_score &vs2){
-    return *vs1.score > *vs2.score;
-  }
   void _init();
   void _init_var_info();
   void _init_watch();
@@ -84,9 +90,21 @@ private:
   void _fill_1_phase_var(vector<int> &);
 
   bool _branch_get_bcp_clause(vector<int> &);
-  void _update_watch(vector<int> &);
+  int _decide_assumption(vector<int> &);
+  void _update_watch(vector<int> &, unsigned);
   bool _try_move_watch(int *, int *, vector<int> &);
+  void _append_occ(int, vector<int> &);
+  int _n_occ(int);
+  static int _lit_idx(int lit){
+    return 2*abs(lit) + (unsigned(lit) >> 31); // 2v for v, 2v+1 for -v, no branch
+  }
+  void _add_bin_watch(int);
+  bool _bin_bcp(vector<int> &, int &, int &);
+  bool _amo_bcp(int, vector<int> &, int &, int &);
   bool _bcp(vector<int> &, int &, int &);
+  bool _xor_bcp(vector<int> &, int &, int &);
+  vector<int> &_reason_clause(int, int);
+  int _implied_level(int, int);
   bool _has_decision();
   int _analyze_conflict(int, int, bool &, vector<int> &);
   bool _try_find_1uip(vector<int> &);
@@ -95,15 +113,48 @@ private:
   int _check_learnt_clause(vector<int> &);
   void _add_learnt_clause(vector<int> &);
   void _backtrack(int, vector<int> &);
+  void _backtrack_to_conflict(vector<int> &);
+  unsigned _pop_trail(int, bool, vector<int> &);
+
+  bool _block_model(const vector<int> &, vector<int> &);
+  void _write_model(const vector<int> &, ostream &);
 
   void _restart();
+  void _reduce_learnt();
+  void _save_best_trail();
   
   vector<vector<int> > _clause_db;
+  vector<int> _clause_lbd; // glue of each clause when learnt, its size otherwise
+  long _clause_bytes;
   vector<twoidx> _watch_db;
-  vector<var_info> _var_info_vec;
+  // implicit binary watches, indexed by _lit_idx of the literal becoming true:
+  // flat pairs of (implied literal, clause idx) for every binary clause
+  // containing the negation of that literal
+  vector<vector<int> > _bin_watch;
+  vector<int> _bin_queue; // assigned literals waiting for binary propagation
+  unsigned _bin_head;
+  // variable state by var, one dense array per field; [0] not used
+  vector<int> _value; // the true literal of the var, UNASSIGNED otherwise
+  // the following three only valid when value not UNASSIGNED
+  vector<int> _level;
+  vector<int> _antec; // NO_ANTEC means it's a decision
+  vector<int> _order; // trail position
+  vector<char> _seen;  // marks of _try_find_1uip, all clear between calls
+  vector<int> _analyzed; // vars of the last conflict analysis, reasons resolved away included
+  vector<char> _lit_mark; // by var, 1 positive 2 negative, all clear between uses
+  // occurrences of each literal by _lit_idx, binary clauses aside: CSR over
+  // the clauses at _init, the clauses learnt since in _occ_extra
+  vector<int> _occ_start;
+  vector<int> _occ;
+  vector<vector<int> > _occ_extra;
+  // truth value of every literal by _lit_idx, padded for the simd gathers
+  vector<signed char> _lit_value;
   deque<assignment> _assign_deque;
-  vector<var_score> _to_assign_heap;
-  vector<int> _to_assign_vec;
+  vector<int> _score; // occurrence weights by var at _init, the deciders start from them
+  vector<int> _warm_rank; // activity order of a checkpoint, blended into _score; empty if none
+  decider *_decider; // picks the heuristic branches
+  decider *_phase_decider[2]; // for fast and for far apart restarts, the same one unless switching
+  vector<int> _to_assign_vec; // the random branches pick from it
 
   unsigned int _seed;
   unsigned int _numerator, _denominator;
@@ -116,6 +167,27 @@ private:
   int _n_conflict_to_restart;
   int _n_conflict_to_restart_bound;
   bool _has_add_clause;
+  drat_buffer *_proof; // NULL unless proof logging is on
+  mem_governor *_governor; // NULL unless a memory limit is set
+  int _governor_slot;
+  gauss_matrix *_gauss; // NULL unless the formula has xors
+  vector<vector<int> > _xor_reason; // row clauses behind xor implications and conflicts
+  // at-most-one groups flat in CSR layout, and the groups of each lit by _lit_idx
+  vector<int> _amo_lits;
+  vector<int> _amo_start;
+  vector<vector<int> > _amo_occ; // empty unless the formula has groups
+  vector<int> _amo_reason; // scratch, the binary clause behind an amo implication
+  int _chrono; // backjump distance that only backtracks one level, 0 for off
+  vector<int> _saved_phase; // empty means random polarity
+  vector<int> _best_phase;  // assignment of the longest trail seen at a conflict
+  int _best_trail;
+  long _n_conflicts;
+  long _n_decisions;
+  long _n_assigns;
+  vector<int> _assumptions;  // cube literals, decided before anything else
+  bool _enumerating;         // every model counts: no pure literals, long learnt clauses kept
+  int _assump_level;         // highest decision level holding an assumption
+  vector<vector<int> > _short_learnt; // learnt units and binaries not yet shared
   
 };
 
@@ -128,7 +200,19 @@ struct mt_arg{
   int denominator;
   int n_conflict_to_return;
   char *result_file_name;
+  int n_out_var; // vars of the input formula, aux vars above it stay out of models
   pthread_mutex_t *mutex;
+  drat_writer *proof;
+  phase_pool *phases;
+  mem_governor *governor;
+  clause_filter *filter; // shared clauses seen so far, checked at export
+  gauss_matrix *gauss; // the xors in echelon form, copied by every solver
+  vector<vector<int> > *amo; // at-most-one groups standing for their binary clauses
+  int chrono; // chronological backtracking threshold, 0 for off
+  int branch; // decision heuristic, BRANCH_MIX spreads them over the threads
+  const checkpoint *warm; // phase and activity order to start from, NULL if none
+  bool keep_activity; // learn threads return their activities, for checkpoints
+  bool deterministic; // per-thread seeds and fixed conflict budgets per round
   bool time_to_ret;
   mt_arg(
       vector<vector<int> > *c, 
@@ -148,18 +232,100 @@ struct mt_arg{
     denominator(d),
     n_conflict_to_return(ret),
     result_file_name(f),
-    mutex(t){;}
+    n_out_var(m),
+    mutex(t),
+    proof(NULL),
+    phases(NULL),
+    governor(NULL),
+    filter(NULL),
+    gauss(NULL),
+    amo(NULL),
+    chrono(0),
+    branch(BRANCH_VSIDS),
+    warm(NULL),
+    keep_activity(false),
+    deterministic(false){;}
+};
+
+struct mt_thread_arg{
+  mt_arg *arg;
+  int idx;
+  unsigned int seed;  // only used in deterministic mode
+  bool time_to_ret;   // private stop flag in deterministic mode
+  strategy settings;  // of this round
+  int arm;            // portfolio arm of the settings, -1 on the fixed schedule
 };
 
 struct mt_learn_ret{
   int status;
   vector<vector<int> > learnt_clause;
+  vector<int> learnt_lbd;
+  vector<int> best_phase;
+  int best_trail;
+  vector<double> activity; // by var, only with keep_activity
+  long n_conflict;
+  long n_decision;
+  long n_assign;
+  sat *solver; // deterministic mode only: finished solver, settled by main
+};
+
+struct mt_sls_arg{
+  sls *sls_solver;
+  mt_arg *arg;
+  int idx;
+  int seen_version;
+  int max_flips; // deterministic mode only
+  bool solved;
 };
 
 void *mt_learn(void *);
 
+void filter_export(mt_arg *, vector<vector<int> > &, vector<int> &);
+
 void *mt_solve(void *);
 
+void enumerate_models(mt_arg *, const vector<int> &, long, unsigned int);
+
+void *mt_sls(void *);
+
+void *mt_sls_step(void *);
+
+void sls_exchange(mt_sls_arg *);
+
+struct mt_cube_arg{
+  mt_arg *arg;
+  cube_tree *tree;
+  cube_queue *queue;
+  int worker;
+};
+
+void *mt_cube(void *);
+
+struct mt_serve_arg{
+  job_server *server;
+  mt_arg *arg; // solver settings of every job
+  bool use_xor;
+  bool use_amo;
+  int worker;
+};
+
+void *mt_serve(void *);
+
+void solve_job(mt_serve_arg *, server_job *);
+
+unsigned int derive_seed(unsigned int, int, int);
+
+int thread_branch(int, int);
+
+bool parse_var_list(const char *, vector<int> &);
+
+int save_checkpoint(const char *, uint64_t, int, const vector<vector<int> > &, const vector<int> &, int, const vector<int> &, const vector<double> &);
+
+void on_stop_signal(int);
+
+volatile sig_atomic_t stop_signal; // SIGTERM or SIGINT once caught, 0 before
+bool *stop_round; // ends the running learn round early, set from the handler
+
 struct timespec sat_start_time;
 struct timespec sat_cur_time;
 struct timespec sat_end_time;
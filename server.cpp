@@ -0,0 +1,467 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <sstream>
+#include "parser.h"
+#include "server.h"
+
+using namespace std;
+
+/* the protocol, one request per line:
+ *   SOLVE <dimacs|binary> <bytes> [<sec>]  then the payload of <bytes> bytes;
+ *     answers BUSY, or c job <id> queued, c job <id> running and finally
+ *     s SATISFIABLE with a v line, s UNSATISFIABLE or s UNKNOWN. <sec>
+ *     counts from the queued line, time spent waiting for a worker included
+ *   CANCEL [<id>]  any job by id, the own running job without
+ *   STATS          queue and pool counters
+ *   QUIT
+ * errors come back as ERROR <reason>. var indices above the p cnf count or
+ * SERVER_MAX_VARS are refused before the job is queued */
+
+server_job::server_job():
+  stop(false),
+  answer(JOB_UNKNOWN){
+  pthread_mutex_init(&stop_mutex, NULL);
+}
+
+server_job::~server_job(){
+  pthread_mutex_destroy(&stop_mutex);
+}
+
+bool server_job::stopped(){
+  pthread_mutex_lock(&stop_mutex);
+  bool stopped = stop;
+  pthread_mutex_unlock(&stop_mutex);
+  return stopped;
+}
+
+void server_job::request_stop(){
+  pthread_mutex_lock(&stop_mutex);
+  stop = true;
+  pthread_mutex_unlock(&stop_mutex);
+}
+
+job_server::job_server(int queue_limit, int client_limit):
+  _queue_limit(queue_limit),
+  _client_limit(client_limit),
+  _n_client(0),
+  _n_running(0),
+  _next_id(1),
+  _n_done(0),
+  _n_busy(0){
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_cond, NULL);
+}
+
+job_server::~job_server(){
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_mutex);
+}
+
+int job_server::submit(server_job *job){
+  pthread_mutex_lock(&_mutex);
+  if(int(_waiting.size()) >= _queue_limit){
+    ++_n_busy;
+    pthread_mutex_unlock(&_mutex);
+    return -1;
+  }
+  job->id = _next_id++;
+  job->state = JOB_QUEUED;
+  _jobs[job->id] = job;
+  _waiting.push_back(job);
+  pthread_cond_signal(&_cond);
+  pthread_mutex_unlock(&_mutex);
+  return job->id;
+}
+
+server_job *job_server::next(){
+  pthread_mutex_lock(&_mutex);
+  while(_waiting.empty())
+    pthread_cond_wait(&_cond, &_mutex);
+  server_job *job = _waiting.front();
+  _waiting.pop_front();
+  job->state = JOB_RUNNING;
+  ++_n_running;
+  pthread_mutex_unlock(&_mutex);
+  return job;
+}
+
+void job_server::finish(server_job *job){
+  pthread_mutex_lock(&_mutex);
+  job->state = JOB_DONE;
+  --_n_running;
+  ++_n_done;
+  pthread_mutex_unlock(&_mutex);
+}
+
+int job_server::state(server_job *job){
+  pthread_mutex_lock(&_mutex);
+  int state = job->state;
+  pthread_mutex_unlock(&_mutex);
+  return state;
+}
+
+bool job_server::cancel(int id){
+  /* a job still waiting leaves the queue, done at once */
+  pthread_mutex_lock(&_mutex);
+  map<int, server_job *>::iterator jit = _jobs.find(id);
+  bool found = jit != _jobs.end() && jit->second->state != JOB_DONE;
+  if(found)
+    jit->second->request_stop();
+  if(found && jit->second->state == JOB_QUEUED){
+    _waiting.erase(find(_waiting.begin(), _waiting.end(), jit->second));
+    jit->second->state = JOB_DONE;
+    ++_n_done;
+  }
+  pthread_mutex_unlock(&_mutex);
+  return found;
+}
+
+void job_server::collect(server_job *job){
+  pthread_mutex_lock(&_mutex);
+  _jobs.erase(job->id);
+  pthread_mutex_unlock(&_mutex);
+}
+
+bool job_server::add_client(){
+  pthread_mutex_lock(&_mutex);
+  bool admitted = _n_client < _client_limit;
+  if(admitted)
+    ++_n_client;
+  else
+    ++_n_busy;
+  pthread_mutex_unlock(&_mutex);
+  return admitted;
+}
+
+void job_server::remove_client(){
+  pthread_mutex_lock(&_mutex);
+  --_n_client;
+  pthread_mutex_unlock(&_mutex);
+}
+
+string job_server::stats(){
+  ostringstream out;
+  pthread_mutex_lock(&_mutex);
+  out << "c queued " << _waiting.size() << " running " << _n_running << " done " << _n_done
+      << " busy " << _n_busy << " clients " << _n_client << "\n";
+  pthread_mutex_unlock(&_mutex);
+  return out.str();
+}
+
+bool parse_binary_clauses(vector<vector<int> > &clauses, int &maxVarIndex, const char *data, size_t size){
+  maxVarIndex = 0;
+  vector<int> clause;
+  unsigned int u = 0;
+  int shift = 0;
+  for(size_t i=0; i<size; ++i){
+    unsigned char byte = data[i];
+    if(shift > 28)
+      return false;
+    u |= (byte & 127u) << shift;
+    shift += 7;
+    if(byte & 128)
+      continue;
+    if(u == 0){
+      clauses.push_back(clause);
+      clause.clear();
+    }
+    else if(u == 1) // -0
+      return false;
+    else{
+      int var = u / 2;
+      clause.push_back(u % 2 ? -var : var);
+      if(var > maxVarIndex)
+        maxVarIndex = var;
+    }
+    u = 0;
+    shift = 0;
+  }
+  return shift == 0 && clause.empty();
+}
+
+static bool vars_in_range(const vector<vector<int> > &clauses, int max_var){
+  for(vector<vector<int> >::const_iterator cit=clauses.begin(); cit!=clauses.end(); ++cit)
+    for(vector<int>::const_iterator lit=cit->begin(); lit!=cit->end(); ++lit)
+      if(*lit < -max_var || *lit > max_var)
+        return false;
+  return true;
+}
+
+/* buffered reads and whole writes on a client socket */
+class client_stream {
+public:
+  client_stream(int fd):_fd(fd){;}
+  bool read_line(string &);
+  bool read_bytes(size_t, string &);
+  int poll_line(string &, int);
+  bool write(const string &);
+private:
+  bool _take_line(string &);
+  bool _fill();
+  int _fd;
+  string _buf;
+};
+
+bool client_stream::_take_line(string &fill_line){
+  size_t end = _buf.find('\n');
+  if(end == string::npos)
+    return false;
+  fill_line = _buf.substr(0, end);
+  if(!fill_line.empty() && fill_line[fill_line.size()-1] == '\r')
+    fill_line.erase(fill_line.size()-1);
+  _buf.erase(0, end + 1);
+  return true;
+}
+
+bool client_stream::_fill(){
+  char chunk[SERVER_READ_SIZE];
+  ssize_t n = recv(_fd, chunk, sizeof(chunk), 0);
+  while(n < 0 && errno == EINTR)
+    n = recv(_fd, chunk, sizeof(chunk), 0);
+  if(n <= 0)
+    return false;
+  _buf.append(chunk, n);
+  return true;
+}
+
+bool client_stream::read_line(string &fill_line){
+  while(!_take_line(fill_line))
+    if(_buf.size() > SERVER_READ_SIZE || !_fill())
+      return false;
+  return true;
+}
+
+bool client_stream::read_bytes(size_t size, string &fill_data){
+  while(_buf.size() < size)
+    if(!_fill())
+      return false;
+  fill_data = _buf.substr(0, size);
+  _buf.erase(0, size);
+  return true;
+}
+
+int client_stream::poll_line(string &fill_line, int timeout_ms){
+  /* 1 with a line, 0 if none came in time, -1 once the client is gone */
+  if(_take_line(fill_line))
+    return 1;
+  struct pollfd pfd;
+  pfd.fd = _fd;
+  pfd.events = POLLIN;
+  if(poll(&pfd, 1, timeout_ms) <= 0)
+    return 0;
+  if(!_fill() || _buf.size() > SERVER_READ_SIZE)
+    return -1;
+  return _take_line(fill_line) ? 1 : 0;
+}
+
+bool client_stream::write(const string &text){
+  size_t sent = 0;
+  while(sent < text.size()){
+    ssize_t n = send(_fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n <= 0)
+      return false;
+    sent += n;
+  }
+  return true;
+}
+
+struct client_arg {
+  job_server *server;
+  int fd;
+  double max_time;
+};
+
+static double elapsed_sec(const struct timespec &start){
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec - start.tv_sec + double(now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void run_job(client_stream &conn, job_server *server, server_job *job, double time_limit){
+  /* stream the job state until a worker is done with it, stopping it on
+   * timeout, CANCEL or a closed connection. the time limit runs from the
+   * submit, waiting in the queue included */
+  ostringstream out;
+  out << "c job " << job->id << " queued\n";
+  bool connected = conn.write(out.str());
+  bool running = false, timed_out = false;
+  struct timespec submitted, start;
+  clock_gettime(CLOCK_MONOTONIC, &submitted);
+  while(true){
+    int state = server->state(job);
+    if(state == JOB_DONE)
+      break;
+    if(state == JOB_RUNNING && !running){
+      running = true;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      out.str("");
+      out << "c job " << job->id << " running\n";
+      connected = connected && conn.write(out.str());
+    }
+    if(!timed_out && elapsed_sec(submitted) > time_limit){
+      timed_out = true;
+      server->cancel(job->id);
+    }
+    string line;
+    int polled = connected ? conn.poll_line(line, SERVER_POLL_MS) : 0;
+    if(!connected)
+      usleep(SERVER_POLL_MS * 1000);
+    if(polled < 0){
+      connected = false;
+      server->cancel(job->id);
+    }
+    else if(polled > 0){
+      istringstream in(line);
+      string cmd;
+      int id;
+      if(!(in >> cmd >> id))
+        id = job->id;
+      out.str("");
+      if(cmd == "CANCEL" && server->cancel(id))
+        out << "c job " << id << " cancelling\n";
+      else if(cmd == "CANCEL")
+        out << "ERROR no job " << id << "\n";
+      else if(cmd == "STATS")
+        out << server->stats();
+      else
+        out << "ERROR job " << job->id << " running, only CANCEL and STATS\n";
+      connected = conn.write(out.str());
+    }
+  }
+  server->collect(job);
+  if(!connected)
+    return;
+
+  out.str("");
+  if(running)
+    out << "c job " << job->id << " done. " << elapsed_sec(start) << " sec\n";
+  if(job->answer == JOB_SAT){
+    out << "s SATISFIABLE\nv";
+    for(unsigned v=1; v<job->model.size(); ++v)
+      out << ' ' << job->model[v];
+    out << " 0\n";
+  }
+  else if(job->answer == JOB_UNSAT)
+    out << "s UNSATISFIABLE\n";
+  else
+    out << "c job " << job->id << (timed_out ? " timeout\n" : " cancelled\n") << "s UNKNOWN\n";
+  conn.write(out.str());
+}
+
+static void *serve_client(void *arg_in){
+  client_arg *arg = static_cast<client_arg *>(arg_in);
+  client_stream conn(arg->fd);
+  string line;
+  while(conn.read_line(line)){
+    istringstream in(line);
+    string cmd;
+    in >> cmd;
+    if(cmd == "SOLVE"){
+      string format;
+      long size = -1;
+      double time_limit = arg->max_time;
+      in >> format >> size;
+      if(!(in >> time_limit) || time_limit <= 0 || time_limit > arg->max_time)
+        time_limit = arg->max_time;
+      if((format != "dimacs" && format != "binary") || size < 0 || size > SERVER_MAX_PAYLOAD){
+        conn.write("ERROR usage: SOLVE <dimacs|binary> <bytes> [<sec>]\n");
+        break; // the payload cannot be skipped
+      }
+      string payload;
+      if(!conn.read_bytes(size, payload))
+        break;
+      server_job *job = new server_job;
+      int header_vars = -1;
+      bool ok = format == "dimacs" ?
+        parse_DIMACS_buffer(job->clause_db, job->max_var_idx, header_vars, payload.data(), payload.size()) :
+        parse_binary_clauses(job->clause_db, job->max_var_idx, payload.data(), payload.size());
+      string().swap(payload);
+      int max_var = header_vars >= 0 && header_vars < SERVER_MAX_VARS ? header_vars : SERVER_MAX_VARS;
+      ostringstream out;
+      out << "ERROR var index out of range, at most " << max_var << "\n";
+      if(!ok)
+        conn.write("ERROR payload is not valid " + format + "\n");
+      else if(!vars_in_range(job->clause_db, max_var))
+        conn.write(out.str());
+      else if(arg->server->submit(job) < 0)
+        conn.write("BUSY\n");
+      else
+        run_job(conn, arg->server, job, time_limit);
+      delete job;
+    }
+    else if(cmd == "CANCEL"){
+      int id = 0;
+      in >> id;
+      ostringstream out;
+      if(arg->server->cancel(id))
+        out << "c job " << id << " cancelling\n";
+      else
+        out << "ERROR no job " << id << "\n";
+      conn.write(out.str());
+    }
+    else if(cmd == "STATS")
+      conn.write(arg->server->stats());
+    else if(cmd == "QUIT")
+      break;
+    else if(!cmd.empty())
+      conn.write("ERROR unknown request, SOLVE, CANCEL, STATS or QUIT\n");
+  }
+  close(arg->fd);
+  arg->server->remove_client();
+  delete arg;
+  return NULL;
+}
+
+int serve(const char *path, job_server *server, double max_time){
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(strlen(path) >= sizeof(addr.sun_path)){
+    fprintf(stderr, "ERROR! Socket path too long: %s\n", path);
+    return 1;
+  }
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path);
+  if(fd < 0 || bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0){
+    fprintf(stderr, "ERROR! Could not listen on socket: %s\n", path);
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  printf("\nlistening on %s\n", path);
+  fflush(stdout);
+
+  while(true){
+    int client = accept(fd, NULL, NULL);
+    if(client < 0)
+      continue;
+    if(!server->add_client()){
+      client_stream(client).write("BUSY\n");
+      close(client);
+      continue;
+    }
+    client_arg *arg = new client_arg;
+    arg->server = server;
+    arg->fd = client;
+    arg->max_time = max_time;
+    pthread_t tid;
+    if(pthread_create(&tid, NULL, &serve_client, arg) != 0){
+      close(client);
+      server->remove_client();
+      delete arg;
+      continue;
+    }
+    pthread_detach(tid);
+  }
+  return 0;
+}
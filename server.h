@@ -0,0 +1,83 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <pthread.h>
+#include <time.h>
+#include <map>
+#include <deque>
+#include <string>
+#include <vector>
+using std::vector;
+
+#define SERVER_QUEUE_LIMIT 64       // waiting jobs, more get BUSY
+#define SERVER_MAX_CLIENTS 256      // open connections, more get BUSY
+#define SERVER_JOB_TIME 60          // sec, default and cap of a job time limit
+#define SERVER_MAX_PAYLOAD (1 << 28)
+#define SERVER_MAX_VARS (1 << 22)   // var index cap, also under the p cnf count if given
+#define SERVER_POLL_MS 50           // how often a waiting client checks its job
+#define SERVER_READ_SIZE 65536
+
+#define JOB_QUEUED 0
+#define JOB_RUNNING 1
+#define JOB_DONE 2
+
+// answers as SAT competition exit codes
+#define JOB_UNKNOWN 0
+#define JOB_SAT 10
+#define JOB_UNSAT 20
+
+/* one formula to solve. the client thread owns it; a worker only touches
+ * it between next() and finish() */
+struct server_job {
+  server_job();
+  ~server_job();
+  bool stopped();
+  void request_stop();
+  int id;
+  int state; // JOB_QUEUED, RUNNING or DONE, under the server mutex
+  vector<vector<int> > clause_db;
+  int max_var_idx;
+  bool stop; // under stop_mutex, polled by the solver: cancelled, out of time or client gone
+  pthread_mutex_t stop_mutex;
+  int answer;
+  vector<int> model; // by var, the true literal when JOB_SAT
+};
+
+/* the bounded job queue between client threads and the worker pool, and
+ * the index of the jobs not yet collected by their clients for CANCEL */
+class job_server {
+public:
+  job_server(int, int);
+  ~job_server();
+  int submit(server_job *); // the job id, -1 if the queue is full
+  server_job *next();       // blocks until a job is queued
+  void finish(server_job *);
+  int state(server_job *);
+  bool cancel(int);
+  void collect(server_job *);
+  bool add_client();
+  void remove_client();
+  std::string stats();
+private:
+  std::deque<server_job *> _waiting;
+  std::map<int, server_job *> _jobs;
+  int _queue_limit;
+  int _client_limit;
+  int _n_client;
+  int _n_running;
+  int _next_id;
+  long _n_done;
+  long _n_busy;
+  pthread_mutex_t _mutex;
+  pthread_cond_t _cond;
+};
+
+/* literals as 2*var+sign in 7-bit varints as in binary DRAT, a 0 after
+ * every clause; false on a truncated or malformed payload */
+bool parse_binary_clauses(vector<vector<int> > &, int &, const char *, size_t);
+
+/* listens on the unix socket at path, one detached thread per client; only
+ * returns if the socket cannot be set up */
+int serve(const char *, job_server *, double);
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include "simd.h"
+
+static inline int lit_code(int lit){
+  return lit > 0 ? 2*lit : -2*lit+1;
+}
+
+static int first_non_false_scalar(const int *lits, int n, const signed char *value){
+  for(int i=0; i<n; ++i)
+    if(value[lit_code(lits[i])] != LIT_FALSE)
+      return i;
+  return n;
+}
+
+static bool any_true_scalar(const int *lits, int n, const signed char *value){
+  for(int i=0; i<n; ++i)
+    if(value[lit_code(lits[i])] == LIT_TRUE)
+      return true;
+  return false;
+}
+
+static int count_zero_scalar(const int *idx, int n, const int *count){
+  int zero = 0;
+  for(int i=0; i<n; ++i)
+    zero += count[idx[i]] == 0;
+  return zero;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i gather_values(const int *lits, const signed char *value){
+  /* code = 2*|lit| + sign bit, then the byte at value+code sign extended */
+  __m256i lit = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lits));
+  __m256i code = _mm256_add_epi32(_mm256_slli_epi32(_mm256_abs_epi32(lit), 1), _mm256_srli_epi32(lit, 31));
+  __m256i word = _mm256_i32gather_epi32(reinterpret_cast<const int *>(value), code, 1);
+  return _mm256_srai_epi32(_mm256_slli_epi32(word, 24), 24);
+}
+
+__attribute__((target("avx2")))
+static int first_non_false_avx2(const int *lits, int n, const signed char *value){
+  const __m256i is_false = _mm256_set1_epi32(LIT_FALSE);
+  int i = 0;
+  for(; i+8<=n; i+=8){
+    __m256i hit = _mm256_cmpeq_epi32(gather_values(lits + i, value), is_false);
+    int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(hit)) & 0xff;
+    if(mask)
+      return i + __builtin_ctz(mask);
+  }
+  return i + first_non_false_scalar(lits + i, n - i, value);
+}
+
+__attribute__((target("avx2")))
+static bool any_true_avx2(const int *lits, int n, const signed char *value){
+  const __m256i is_true = _mm256_set1_epi32(LIT_TRUE);
+  int i = 0;
+  for(; i+8<=n; i+=8){
+    __m256i hit = _mm256_cmpeq_epi32(gather_values(lits + i, value), is_true);
+    if(_mm256_movemask_ps(_mm256_castsi256_ps(hit)))
+      return true;
+  }
+  return any_true_scalar(lits + i, n - i, value);
+}
+
+__attribute__((target("avx2")))
+static int count_zero_avx2(const int *idx, int n, const int *count){
+  const __m256i zero = _mm256_setzero_si256();
+  int n_zero = 0;
+  int i = 0;
+  for(; i+8<=n; i+=8){
+    __m256i id = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + i));
+    __m256i hit = _mm256_cmpeq_epi32(_mm256_i32gather_epi32(count, id, 4), zero);
+    n_zero += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+  }
+  return n_zero + count_zero_scalar(idx + i, n - i, count);
+}
+
+static bool use_avx2(){
+  const char *env = getenv("YASAT_SIMD");
+  if(env != NULL && strcmp(env, "scalar") == 0)
+    return false;
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+static const bool has_avx2 = use_avx2();
+
+int (*simd_first_non_false)(const int *, int, const signed char *) = has_avx2 ? first_non_false_avx2 : first_non_false_scalar;
+bool (*simd_any_true)(const int *, int, const signed char *) = has_avx2 ? any_true_avx2 : any_true_scalar;
+int (*simd_count_zero)(const int *, int, const int *) = has_avx2 ? count_zero_avx2 : count_zero_scalar;
+
+const char *simd_name(){
+  return has_avx2 ? "avx2" : "scalar";
+}
@@ -0,0 +1,24 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+/* scanning kernels over DIMACS literals. the value of lit is read at its
+ * code 2*v+sign, i.e. value[lit > 0 ? 2*lit : -2*lit+1], with 1 true,
+ * -1 false and 0 unassigned. AVX2 versions gather 8 codes at a time and
+ * are picked at startup when the cpu has AVX2, scalar ones otherwise
+ * (or when YASAT_SIMD=scalar is set) */
+
+#define LIT_TRUE 1
+#define LIT_FALSE -1
+#define LIT_FREE 0
+#define SIMD_VALUE_PAD 4 // slack bytes after a value array, the gathers read 4 bytes
+
+// index of the first literal not false, n if there is none
+extern int (*simd_first_non_false)(const int *, int, const signed char *);
+// whether some literal is true
+extern bool (*simd_any_true)(const int *, int, const signed char *);
+// how many of count[idx[0..n)] are 0
+extern int (*simd_count_zero)(const int *, int, const int *);
+
+const char *simd_name();
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include "simd.h"
+#include "sls.h"
+
+using namespace std;
+
+sls::sls(vector<vector<int> > &clause_db, int max_var_idx, int ori_db_size, unsigned int seed, int mode):
+  _seed(seed),
+  _mode(mode),
+  _max_var_idx(max_var_idx),
+  _n_clause(0),
+  _best_unsat(-1),
+  _has_empty_clause(false),
+  _temperature(SLS_INIT_TEMPERATURE){
+  /* flatten the original clauses, dropping duplicate lits and tautologies */
+  vector<int> occ_count(2*_max_var_idx + 2, 0);
+  _clause_start.push_back(0);
+  for(int c=0; c<ori_db_size; ++c){
+    vector<int> clause = clause_db.at(c);
+    sort(clause.begin(), clause.end());
+    clause.erase(unique(clause.begin(), clause.end()), clause.end());
+    bool tautology = false;
+    for(unsigned i=1; i<clause.size(); ++i)
+      if(binary_search(clause.begin(), clause.end(), -clause.at(i)))
+        tautology = true;
+    if(tautology)
+      continue;
+    if(clause.empty())
+      _has_empty_clause = true;
+    if(clause.size() > _pick_prob.size())
+      _pick_prob.resize(clause.size());
+    for(vector<int>::iterator lit=clause.begin(); lit!=clause.end(); ++lit){
+      _lits.push_back(*lit);
+      ++occ_count.at(_lit_idx(*lit));
+    }
+    _clause_start.push_back(_lits.size());
+    ++_n_clause;
+  }
+  _occ_start.resize(2*_max_var_idx + 3, 0);
+  for(int l=0; l<2*_max_var_idx+2; ++l)
+    _occ_start.at(l+1) = _occ_start.at(l) + occ_count.at(l);
+  _occ.resize(_lits.size());
+  vector<int> fill_pos(_occ_start.begin(), _occ_start.end()-1);
+  for(int c=0; c<_n_clause; ++c)
+    for(int i=_clause_start.at(c); i<_clause_start.at(c+1); ++i)
+      _occ.at(fill_pos.at(_lit_idx(_lits.at(i)))++) = c;
+
+  for(int b=0; b<SLS_BREAK_TABLE_SIZE; ++b)
+    _prob_table[b] = pow(SLS_PROBSAT_EPS + b, -SLS_PROBSAT_CB);
+
+  _value.resize(_max_var_idx + 1);
+  for(int v=1; v<=_max_var_idx; ++v)
+    _value.at(v) = rand_r(&_seed) % 2;
+  _init_assignment();
+}
+
+void sls::set_phase(const vector<int> &phase){
+  /* restart from phase, keeping the current value of unassigned vars */
+  for(int v=1; v<=_max_var_idx && v<int(phase.size()); ++v)
+    if(phase.at(v) != 0)
+      _value.at(v) = phase.at(v) > 0;
+  _temperature = SLS_INIT_TEMPERATURE;
+  _init_assignment();
+}
+
+bool sls::run(int max_flips){
+  /* flip until every clause is satisfied or max_flips is spent */
+  if(_has_empty_clause)
+    return false;
+  for(int f=0; f<max_flips; ++f){
+    if(_unsat.empty())
+      return true;
+    int clause_idx = _unsat[rand_r(&_seed) % _unsat.size()];
+    int var;
+    if(_mode == SLS_WALKSAT)
+      var = _pick_walksat(clause_idx);
+    else if(_mode == SLS_ANNEAL)
+      var = _pick_anneal(clause_idx);
+    else
+      var = _pick_probsat(clause_idx);
+    if(var == 0)
+      continue;
+    _flip(var);
+    if(int(_unsat.size()) < _best_unsat){
+      _best_unsat = _unsat.size();
+      _best_value = _value;
+    }
+    if(_mode == SLS_ANNEAL && _temperature > SLS_MIN_TEMPERATURE)
+      _temperature *= SLS_COOLING;
+  }
+  return _unsat.empty();
+}
+
+void sls::get_best_phase(vector<int> &phase){
+  phase.assign(_max_var_idx + 1, 0);
+  for(int v=1; v<=_max_var_idx; ++v)
+    phase.at(v) = _best_value.at(v) ? v : -v;
+}
+
+void sls::write_result_file(char *filename, int n_out_var){
+  int len = strlen(filename);
+  filename[len-3] = 's'; filename[len-2] = 'a'; filename[len-1] = 't';
+  ofstream fout(filename);
+  fout << "s SATISFIABLE\nv 0 ";
+  for(int v=1; v<=n_out_var; ++v)
+    fout << (_best_value.at(v) ? v : -v) << ' ';
+  fout << "0\n";
+  cout << "SAT\n";
+  fout.close();
+}
+
+void sls::_init_assignment(){
+  _true_count.assign(_n_clause, 0);
+  _true_xor.assign(_n_clause, 0);
+  _break_count.assign(_max_var_idx + 1, 0);
+  _unsat.clear();
+  _unsat_pos.assign(_n_clause, -1);
+  for(int c=0; c<_n_clause; ++c){
+    for(int i=_clause_start[c]; i<_clause_start[c+1]; ++i){
+      int lit = _lits[i];
+      if(_value[abs(lit)] == (lit > 0)){
+        ++_true_count[c];
+        _true_xor[c] ^= abs(lit);
+      }
+    }
+    if(_true_count[c] == 0)
+      _add_unsat(c);
+    else if(_true_count[c] == 1)
+      ++_break_count[_true_xor[c]];
+  }
+  _best_unsat = _unsat.size();
+  _best_value = _value;
+}
+
+void sls::_flip(int var){
+  int new_true = _value[var] ? -var : var;
+  int new_false = -new_true;
+  _value[var] = !_value[var];
+  for(int i=_occ_start[_lit_idx(new_true)]; i<_occ_start[_lit_idx(new_true)+1]; ++i){
+    int c = _occ[i];
+    int n = ++_true_count[c];
+    _true_xor[c] ^= var;
+    if(n == 1){
+      _remove_unsat(c);
+      ++_break_count[var];
+    }
+    else if(n == 2)
+      --_break_count[_true_xor[c] ^ var];
+  }
+  for(int i=_occ_start[_lit_idx(new_false)]; i<_occ_start[_lit_idx(new_false)+1]; ++i){
+    int c = _occ[i];
+    int n = --_true_count[c];
+    _true_xor[c] ^= var;
+    if(n == 0){
+      _add_unsat(c);
+      --_break_count[var];
+    }
+    else if(n == 1)
+      ++_break_count[_true_xor[c]];
+  }
+}
+
+int sls::_make_count(int var){
+  int new_true = _value[var] ? -var : var;
+  int begin = _occ_start[_lit_idx(new_true)], end = _occ_start[_lit_idx(new_true)+1];
+  if(begin == end)
+    return 0;
+  return simd_count_zero(&_occ[begin], end - begin, &_true_count[0]);
+}
+
+int sls::_pick_probsat(int clause_idx){
+  /* probability proportional to (eps + break)^-cb */
+  double *prob = &_pick_prob[0];
+  double sum = 0;
+  for(int i=_clause_start[clause_idx]; i<_clause_start[clause_idx+1]; ++i){
+    int b = _break_count[abs(_lits[i])];
+    prob[i-_clause_start[clause_idx]] = _prob_table[b < SLS_BREAK_TABLE_SIZE ? b : SLS_BREAK_TABLE_SIZE-1];
+    sum += prob[i-_clause_start[clause_idx]];
+  }
+  double r = _rand_double() * sum;
+  int i = _clause_start[clause_idx];
+  for(; i<_clause_start[clause_idx+1]-1; ++i){
+    r -= prob[i-_clause_start[clause_idx]];
+    if(r <= 0)
+      break;
+  }
+  return abs(_lits[i]);
+}
+
+int sls::_pick_walksat(int clause_idx){
+  /* freebie if any, else noisy min break */
+  int best_var = 0, best_break = 0;
+  for(int i=_clause_start[clause_idx]; i<_clause_start[clause_idx+1]; ++i){
+    int var = abs(_lits[i]);
+    if(best_var == 0 || _break_count[var] < best_break){
+      best_var = var;
+      best_break = _break_count[var];
+    }
+  }
+  if(best_break > 0 && rand_r(&_seed) % 1000 < SLS_WALKSAT_NOISE){
+    int size = _clause_start[clause_idx+1] - _clause_start[clause_idx];
+    return abs(_lits[_clause_start[clause_idx] + rand_r(&_seed) % size]);
+  }
+  return best_var;
+}
+
+int sls::_pick_anneal(int clause_idx){
+  /* metropolis acceptance of a random var of the clause, 0 if rejected */
+  int size = _clause_start[clause_idx+1] - _clause_start[clause_idx];
+  int var = abs(_lits[_clause_start[clause_idx] + rand_r(&_seed) % size]);
+  int delta = _break_count[var] - _make_count(var);
+  if(delta <= 0 || _rand_double() < exp(-delta / _temperature))
+    return var;
+  return 0;
+}
+
+void sls::_add_unsat(int clause_idx){
+  _unsat_pos[clause_idx] = _unsat.size();
+  _unsat.push_back(clause_idx);
+}
+
+void sls::_remove_unsat(int clause_idx){
+  int pos = _unsat_pos[clause_idx];
+  int last = _unsat.back();
+  _unsat[pos] = last;
+  _unsat_pos[last] = pos;
+  _unsat.pop_back();
+  _unsat_pos[clause_idx] = -1;
+}
+
+double sls::_rand_double(){
+  return double(rand_r(&_seed)) / (double(RAND_MAX) + 1.0);
+}
@@ -0,0 +1,83 @@
+#ifndef _SLS_H_
+#define _SLS_H_
+
+#include <pthread.h>
+#include <vector>
+using std::vector;
+
+#define SLS_PROBSAT 0
+#define SLS_WALKSAT 1
+#define SLS_ANNEAL 2
+
+#define SLS_FLIPS_PER_ROUND 1000000
+#define SLS_FLIPS_PER_CONFLICT 100 // deterministic mode, against the cdcl round budget
+#define SLS_BREAK_TABLE_SIZE 64
+#define SLS_PROBSAT_CB 2.3
+#define SLS_PROBSAT_EPS 1.0
+#define SLS_WALKSAT_NOISE 567 // out of 1000
+#define SLS_INIT_TEMPERATURE 2.0
+#define SLS_COOLING 0.9999
+#define SLS_MIN_TEMPERATURE 0.05
+
+/* best phases seen so far, exchanged between CDCL and SLS workers.
+ * phases are indexed by var, holding var, -var or UNASSIGNED */
+struct phase_pool {
+  pthread_mutex_t mutex;
+  vector<int> cdcl_phase;
+  int cdcl_trail;   // number of assigned vars in cdcl_phase
+  int cdcl_version; // bumped on every new cdcl_phase
+  vector<int> sls_phase;
+  int sls_unsat;    // unsatisfied clauses under sls_phase, -1 if none yet
+  phase_pool():cdcl_trail(0), cdcl_version(0), sls_unsat(-1){
+    pthread_mutex_init(&mutex, NULL);
+  }
+};
+
+class sls {
+public:
+  sls(vector<vector<int> > &, int, int, unsigned int, int);
+  void set_phase(const vector<int> &);
+  bool run(int);
+  int best_unsat(){ return _best_unsat; }
+  void get_best_phase(vector<int> &);
+  void write_result_file(char *, int);
+private:
+  void _init_assignment();
+  void _flip(int);
+  int _make_count(int);
+  int _pick_probsat(int);
+  int _pick_walksat(int);
+  int _pick_anneal(int);
+  void _add_unsat(int);
+  void _remove_unsat(int);
+  static int _lit_idx(int lit){
+    return 2*abs(lit) + (unsigned(lit) >> 31);
+  }
+  double _rand_double();
+
+  /* clauses and literal occurrences, flat in CSR layout */
+  vector<int> _lits;
+  vector<int> _clause_start;
+  vector<int> _occ;
+  vector<int> _occ_start;
+
+  vector<char> _value;      // per var, 1 means true
+  vector<int> _true_count;  // per clause
+  vector<int> _true_xor;    // xor of the true vars of each clause
+  vector<int> _break_count; // per var, clauses only it satisfies
+  vector<int> _unsat;
+  vector<int> _unsat_pos;   // per clause, -1 if satisfied
+  vector<char> _best_value;
+  double _prob_table[SLS_BREAK_TABLE_SIZE];
+  vector<double> _pick_prob; // scratch, one entry per lit of the picked clause
+
+  unsigned int _seed;
+  int _mode;
+  int _max_var_idx;
+  int _n_clause;
+  int _best_unsat;
+  bool _has_empty_clause;
+  double _temperature;
+};
+
+#endif
@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include <time.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "symmetry.h"
+
+using namespace std;
+
+#define COLOR_POS_LIT 0
+#define COLOR_NEG_LIT 1
+#define COLOR_CLAUSE 2
+
+static uint64_t mix(uint64_t x){
+  x ^= x >> 33;
+  x *= UINT64_C(0xff51afd7ed558ccd);
+  x ^= x >> 33;
+  return x;
+}
+
+static int lit_vertex(int lit){
+  return 2*(abs(lit)-1) + (lit < 0);
+}
+
+/* literal vertices paired by an edge, one vertex per clause joined to its
+ * literals. colors keep positive literals, negative literals and clauses
+ * apart, so an automorphism is a variable permutation. generators are
+ * found by individualization and refinement of two colorings at once:
+ * the identity side and the side trying an image */
+class sym_graph {
+public:
+  sym_graph(vector<vector<int> > &, int, double);
+  void find_generators(vector<vector<int> > &);
+private:
+  bool _refine(vector<int> &, vector<int> &);
+  int _first_open(vector<int> &);
+  bool _search(vector<int> &, vector<int> &, int &, vector<int> &);
+  bool _is_automorphism(vector<int> &);
+  bool _out_of_budget();
+  int _find(vector<int> &, int);
+  vector<vector<int> > _adj;
+  vector<int> _color; // initial coloring
+  int _max_var_idx;
+  int _n_nodes;
+  bool _has_deadline;
+  struct timespec _deadline;
+};
+
+sym_graph::sym_graph(vector<vector<int> > &clause_db, int max_var_idx, double time_budget):
+  _max_var_idx(max_var_idx),
+  _n_nodes(0),
+  _has_deadline(time_budget > 0){
+  _adj.resize(2*max_var_idx);
+  for(int v=1; v<=max_var_idx; ++v){
+    _adj.at(lit_vertex(v)).push_back(lit_vertex(-v));
+    _adj.at(lit_vertex(-v)).push_back(lit_vertex(v));
+  }
+  for(vector<vector<int> >::iterator cit=clause_db.begin(); cit!=clause_db.end(); ++cit){
+    int c = _adj.size();
+    _adj.push_back(vector<int>());
+    for(vector<int>::iterator lit=cit->begin(); lit!=cit->end(); ++lit){
+      _adj.at(c).push_back(lit_vertex(*lit));
+      _adj.at(lit_vertex(*lit)).push_back(c);
+    }
+  }
+  for(vector<vector<int> >::iterator ait=_adj.begin(); ait!=_adj.end(); ++ait){
+    sort(ait->begin(), ait->end());
+    ait->erase(unique(ait->begin(), ait->end()), ait->end());
+  }
+  _color.assign(_adj.size(), COLOR_CLAUSE);
+  for(int v=1; v<=max_var_idx; ++v){
+    _color.at(lit_vertex(v)) = COLOR_POS_LIT;
+    _color.at(lit_vertex(-v)) = COLOR_NEG_LIT;
+  }
+  if(_has_deadline){
+    clock_gettime(CLOCK_MONOTONIC, &_deadline);
+    long nsec = _deadline.tv_nsec + long((time_budget - long(time_budget)) * 1e9);
+    _deadline.tv_sec += long(time_budget) + nsec / 1000000000;
+    _deadline.tv_nsec = nsec % 1000000000;
+  }
+}
+
+bool sym_graph::_out_of_budget(){
+  if(_n_nodes > SYMMETRY_TOTAL_NODES)
+    return true;
+  if(!_has_deadline)
+    return false;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec > _deadline.tv_sec || (now.tv_sec == _deadline.tv_sec && now.tv_nsec >= _deadline.tv_nsec);
+}
+
+bool sym_graph::_refine(vector<int> &left, vector<int> &right){
+  /* recolor both sides by a hash of (color, neighbour colors) until stable.
+   * new colors are ranks of the hashes, so equal on both sides; false if
+   * the sides split differently, i.e. no automorphism maps one to the other.
+   * a collision only merges cells, leaves are checked edge by edge */
+  int n = _adj.size();
+  int n_color = -1;
+  vector<uint64_t> sig_left(n), sig_right(n);
+  while(true){
+    for(int u=0; u<n; ++u){
+      uint64_t sum_left = 0, sum_right = 0;
+      for(vector<int>::iterator x=_adj[u].begin(); x!=_adj[u].end(); ++x){
+        sum_left += mix(left[*x]);
+        sum_right += mix(right[*x]);
+      }
+      sig_left[u] = mix(left[u] ^ mix(sum_left));
+      sig_right[u] = mix(right[u] ^ mix(sum_right));
+    }
+    vector<uint64_t> sorted_left(sig_left), sorted_right(sig_right);
+    sort(sorted_left.begin(), sorted_left.end());
+    sort(sorted_right.begin(), sorted_right.end());
+    if(sorted_left != sorted_right)
+      return false;
+    sorted_left.erase(unique(sorted_left.begin(), sorted_left.end()), sorted_left.end());
+    for(int u=0; u<n; ++u){
+      left[u] = lower_bound(sorted_left.begin(), sorted_left.end(), sig_left[u]) - sorted_left.begin();
+      right[u] = lower_bound(sorted_left.begin(), sorted_left.end(), sig_right[u]) - sorted_left.begin();
+    }
+    if(int(sorted_left.size()) == n_color)
+      return true;
+    n_color = sorted_left.size();
+  }
+}
+
+int sym_graph::_first_open(vector<int> &color){
+  /* smallest vertex in a cell of more than one, -1 if the coloring is discrete */
+  vector<int> cell_size(_adj.size() + 1, 0);
+  for(unsigned u=0; u<color.size(); ++u)
+    ++cell_size.at(color[u]);
+  for(unsigned u=0; u<color.size(); ++u)
+    if(cell_size.at(color[u]) > 1)
+      return u;
+  return -1;
+}
+
+bool sym_graph::_search(vector<int> &left, vector<int> &right, int &budget, vector<int> &perm){
+  ++_n_nodes;
+  if(--budget < 0 || _out_of_budget())
+    return false;
+  if(!_refine(left, right))
+    return false;
+  int n = _adj.size();
+  int v = _first_open(left);
+  if(v < 0){
+    vector<int> vertex_of(n);
+    for(int w=0; w<n; ++w)
+      vertex_of.at(right[w]) = w;
+    perm.resize(n);
+    for(int u=0; u<n; ++u)
+      perm.at(u) = vertex_of.at(left[u]);
+    return _is_automorphism(perm);
+  }
+  vector<int> candidates;
+  if(right[v] == left[v])
+    candidates.push_back(v); // extending like the identity first
+  for(int w=0; w<n; ++w)
+    if(right[w] == left[v] && w != v)
+      candidates.push_back(w);
+  for(vector<int>::iterator w=candidates.begin(); w!=candidates.end(); ++w){
+    vector<int> next_left(left), next_right(right);
+    next_left[v] = n; // fresh color, ranks stay below n
+    next_right[*w] = n;
+    if(_search(next_left, next_right, budget, perm))
+      return true;
+    if(budget < 0)
+      return false;
+  }
+  return false;
+}
+
+bool sym_graph::_is_automorphism(vector<int> &perm){
+  for(unsigned u=0; u<_adj.size(); ++u){
+    if(_color.at(perm[u]) != _color.at(u))
+      return false;
+    vector<int> &image_adj = _adj.at(perm[u]);
+    for(vector<int>::iterator x=_adj[u].begin(); x!=_adj[u].end(); ++x)
+      if(!binary_search(image_adj.begin(), image_adj.end(), perm[*x]))
+        return false;
+  }
+  return true;
+}
+
+int sym_graph::_find(vector<int> &parent, int u){
+  while(parent[u] != u)
+    u = parent[u] = parent[parent[u]];
+  return u;
+}
+
+void sym_graph::find_generators(vector<vector<int> > &generators){
+  /* down the path fixing the smallest open vertex each level, try to map it
+   * onto the rest of its cell. images already in its orbit under the
+   * generators of this level are skipped; those generators fix the path */
+  int n = _adj.size();
+  vector<int> path(_color), right(_color);
+  _refine(path, right);
+  while(!_out_of_budget()){
+    int v = _first_open(path);
+    if(v < 0 || v >= 2*_max_var_idx) // only clause vertices left open
+      break;
+    vector<int> orbit(n);
+    for(int u=0; u<n; ++u)
+      orbit[u] = u;
+    vector<int> fixed(path);
+    fixed[v] = n;
+    for(int w=0; w<n && !_out_of_budget(); ++w){
+      if(w == v || path[w] != path[v] || _find(orbit, w) == _find(orbit, v))
+        continue;
+      vector<int> left(fixed), image(path);
+      image[w] = n;
+      int budget = SYMMETRY_NODE_BUDGET;
+      vector<int> perm;
+      if(!_search(left, image, budget, perm))
+        continue;
+      vector<int> var_perm(_max_var_idx + 1, 0);
+      for(int x=1; x<=_max_var_idx; ++x)
+        var_perm.at(x) = perm.at(lit_vertex(x)) / 2 + 1;
+      generators.push_back(var_perm);
+      for(int u=0; u<n; ++u)
+        orbit[_find(orbit, u)] = _find(orbit, perm[u]);
+    }
+    path = fixed;
+    right = fixed;
+    _refine(path, right);
+  }
+}
+
+static void add_lex_leader(vector<vector<int> > &clause_db, int &max_var_idx, vector<int> &var_perm){
+  /* x <=lex perm(x) over the moved vars in index order. eq says the prefix
+   * so far is equal; with a <= b already required, a = b is just (a or -b),
+   * so every link is two ternary clauses */
+  vector<int> moved;
+  for(unsigned a=1; a<var_perm.size() && int(moved.size())<SYMMETRY_MAX_CHAIN; ++a)
+    if(var_perm.at(a) != int(a))
+      moved.push_back(a);
+  int eq_prev = 0; // 0: the empty prefix, always equal
+  for(unsigned i=0; i<moved.size(); ++i){
+    int a = moved.at(i), b = var_perm.at(a);
+    vector<int> prefix;
+    if(eq_prev != 0)
+      prefix.push_back(-eq_prev);
+    vector<int> le(prefix);
+    le.push_back(-a); le.push_back(b);
+    clause_db.push_back(le);
+    if(i + 1 == moved.size())
+      break;
+    int eq = ++max_var_idx;
+    vector<int> a_true(prefix), b_false(prefix);
+    a_true.push_back(-a); a_true.push_back(eq);
+    b_false.push_back(b); b_false.push_back(eq);
+    clause_db.push_back(a_true);
+    clause_db.push_back(b_false);
+    eq_prev = eq;
+  }
+}
+
+int break_symmetry(vector<vector<int> > &clause_db, int &max_var_idx, double time_budget, int &n_generator){
+  sym_graph graph(clause_db, max_var_idx, time_budget);
+  vector<vector<int> > generators;
+  graph.find_generators(generators);
+  n_generator = generators.size();
+  int ori_size = clause_db.size();
+  for(vector<vector<int> >::iterator git=generators.begin(); git!=generators.end(); ++git)
+    add_lex_leader(clause_db, max_var_idx, *git);
+  return clause_db.size() - ori_size;
+}
@@ -0,0 +1,18 @@
+#ifndef _SYMMETRY_H_
+#define _SYMMETRY_H_
+
+#include <vector>
+using std::vector;
+
+#define SYMMETRY_TIME_BUDGET 1.0  // sec, default of --symmetry
+#define SYMMETRY_NODE_BUDGET 2000 // search nodes per candidate image
+#define SYMMETRY_TOTAL_NODES 200000
+#define SYMMETRY_MAX_CHAIN 64     // lex-leader comparisons per generator
+
+/* finds variable permutations mapping the formula onto itself and appends
+ * lex-leader clauses for each generator, over new aux vars above max_var_idx.
+ * a time budget of 0 leaves only the node budgets, for deterministic runs.
+ * returns the number of clauses added */
+int break_symmetry(vector<vector<int> > &, int &, double, int &);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "trace.h"
+
+static char *trace_file = NULL;
+static struct timespec trace_start;
+static pthread_mutex_t lanes_mutex = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring *lanes[TRACE_MAX_LANES];
+static int n_lane = 0; // under lanes_mutex
+static int dumped = 0;
+static __thread trace_ring *cur_lane = NULL;
+
+void trace_open(const char *filename){
+  trace_file = strdup(filename);
+  clock_gettime(CLOCK_MONOTONIC, &trace_start);
+  atexit(trace_dump);
+  trace_lane("main", 0);
+}
+
+void trace_lane(const char *kind, int idx){
+  /* found by kind and index so a respawned thread continues its row */
+  if(trace_file == NULL)
+    return;
+  pthread_mutex_lock(&lanes_mutex);
+  cur_lane = NULL;
+  for(int i=0; i<n_lane && cur_lane==NULL; ++i)
+    if(strcmp(lanes[i]->kind, kind) == 0 && lanes[i]->idx == idx)
+      cur_lane = lanes[i];
+  if(cur_lane == NULL && n_lane < TRACE_MAX_LANES){
+    cur_lane = new trace_ring;
+    cur_lane->kind = kind;
+    cur_lane->idx = idx;
+    cur_lane->events = new trace_event[TRACE_RING_SIZE];
+    cur_lane->n_event = 0;
+    lanes[n_lane] = cur_lane;
+    __sync_synchronize(); // the dump reads n_lane without the lock
+    ++n_lane;
+  }
+  pthread_mutex_unlock(&lanes_mutex);
+}
+
+static void trace_add(char phase, const char *name, long value){
+  if(cur_lane == NULL)
+    return;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  trace_event &e = cur_lane->events[cur_lane->n_event % TRACE_RING_SIZE];
+  e.name = name;
+  e.ts = (now.tv_sec - trace_start.tv_sec) * 1e6 + (now.tv_nsec - trace_start.tv_nsec) / 1e3;
+  e.value = value;
+  e.phase = phase;
+  __sync_synchronize();
+  cur_lane->n_event = cur_lane->n_event + 1;
+}
+
+void trace_begin(const char *name){
+  trace_add(TRACE_BEGIN, name, 0);
+}
+
+void trace_end(const char *name){
+  trace_add(TRACE_END, name, 0);
+}
+
+void trace_instant(const char *name, long value){
+  trace_add(TRACE_INSTANT, name, value);
+}
+
+void trace_dump(){
+  /* other threads may still be writing: each lane is read up to the count
+   * seen first, ends whose begin was overwritten are dropped */
+  if(trace_file == NULL || !__sync_bool_compare_and_swap(&dumped, 0, 1))
+    return;
+  FILE *fp = fopen(trace_file, "w");
+  if(fp == NULL){
+    fprintf(stderr, "ERROR! Could not open trace file: %s\n", trace_file);
+    return;
+  }
+  int pid = getpid();
+  fprintf(fp, "{\"traceEvents\":[\n");
+  bool first = true;
+  int n = __sync_fetch_and_add(&n_lane, 0);
+  for(int l=0; l<n; ++l){
+    trace_ring *lane = lanes[l];
+    fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}", first ? "" : ",\n", pid, l, lane->kind, lane->idx);
+    first = false;
+    unsigned long end = lane->n_event;
+    __sync_synchronize();
+    unsigned long start = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+    int depth = 0;
+    for(unsigned long i=start; i<end; ++i){
+      const trace_event &e = lane->events[i % TRACE_RING_SIZE];
+      if(e.phase == TRACE_END && depth == 0)
+        continue;
+      depth += e.phase == TRACE_BEGIN ? 1 : (e.phase == TRACE_END ? -1 : 0);
+      fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d", e.name, e.phase, e.ts, pid, l);
+      if(e.phase == TRACE_INSTANT)
+        fprintf(fp, ",\"s\":\"t\",\"args\":{\"value\":%ld}", e.value);
+      fprintf(fp, "}");
+    }
+  }
+  fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(fp);
+}
@@ -0,0 +1,38 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#define TRACE_RING_SIZE (1 << 16) // events per lane, the oldest get overwritten
+#define TRACE_MAX_LANES 1024
+
+#define TRACE_BEGIN 'B'
+#define TRACE_END 'E'
+#define TRACE_INSTANT 'i'
+
+/* event names are string literals, only the pointer is kept */
+struct trace_event {
+  const char *name;
+  double ts; // usec since trace_open
+  long value;
+  char phase; // TRACE_BEGIN, END or INSTANT
+};
+
+/* one timeline row. a single thread writes it at a time: the threads of
+ * one kind and index, e.g. the learner of slot 3 in every round */
+struct trace_ring {
+  const char *kind;
+  int idx;
+  trace_event *events;
+  volatile unsigned long n_event; // ever written, bumped after the event
+};
+
+/* per thread timelines written without locks, dumped at exit as chrome
+ * trace event json for chrome://tracing or perfetto. everything is a no-op
+ * until trace_open, and on a thread until it calls trace_lane */
+void trace_open(const char *);
+void trace_lane(const char *, int);
+void trace_begin(const char *);
+void trace_end(const char *);
+void trace_instant(const char *, long);
+void trace_dump(); // once, also from atexit; later calls do nothing
+
+#endif